@@ -0,0 +1,153 @@
+#include <stdexcept>
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <immintrin.h>
+#endif
+
+#include "BoardSampler.h"
+#include "CpuDispatch.h"
+#include "RandomStream.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+BoardSampler::BoardSampler( CardSet deadCards, std::uint64_t masterSeed, std::uint64_t streamId )
+  : numberOfLiveCards_( 0 )
+{
+  for( unsigned int i = 0; i < CARDS_IN_DECK; ++i ) {
+    if( !deadCards.contains( i ) ) {
+      liveCards_[ numberOfLiveCards_++ ] = Card::rawCard( i );
+    }
+  }
+  threshold_ = numberOfLiveCards_ ? std::uint32_t( -numberOfLiveCards_ ) % numberOfLiveCards_ : 0;
+
+  RandomStream stream( masterSeed, streamId );
+  for( unsigned int lane = 0; lane < SAMPLER_LANES; ++lane ) {
+    std::uint64_t low = stream();
+    std::uint64_t high = stream();
+    state_[ 0 ][ lane ] = std::uint32_t( low );
+    state_[ 1 ][ lane ] = std::uint32_t( low >> 32 );
+    state_[ 2 ][ lane ] = std::uint32_t( high );
+    state_[ 3 ][ lane ] = std::uint32_t( high >> 32 );
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+void BoardSampler::sampleScalar( BoardSampler& sampler, unsigned int cardsPerDraw, unsigned int rawCards[], std::size_t stride )
+{
+  std::uint32_t ( &s )[ 4 ][ SAMPLER_LANES ] = sampler.state_;
+  unsigned int drawn[ MAX_SAMPLED_CARDS ][ SAMPLER_LANES ];
+
+  for( unsigned int c = 0; c < cardsPerDraw; ++c ) {
+    unsigned int pending = ( 1 << SAMPLER_LANES ) - 1;
+    while( pending ) {
+      for( unsigned int lane = 0; lane < SAMPLER_LANES; ++lane ) {
+        std::uint32_t x = s[ 1 ][ lane ] * 5;
+        std::uint32_t random = ( ( x << 7 ) | ( x >> 25 ) ) * 9;
+        std::uint32_t t = s[ 1 ][ lane ] << 9;
+        s[ 2 ][ lane ] ^= s[ 0 ][ lane ];
+        s[ 3 ][ lane ] ^= s[ 1 ][ lane ];
+        s[ 1 ][ lane ] ^= s[ 2 ][ lane ];
+        s[ 0 ][ lane ] ^= s[ 3 ][ lane ];
+        s[ 2 ][ lane ] ^= t;
+        s[ 3 ][ lane ] = ( s[ 3 ][ lane ] << 11 ) | ( s[ 3 ][ lane ] >> 21 );
+
+        std::uint64_t product = std::uint64_t( random ) * sampler.numberOfLiveCards_;
+        unsigned int card = sampler.liveCards_[ product >> 32 ];
+        bool ok = std::uint32_t( product ) >= sampler.threshold_;
+        for( unsigned int d = 0; d < c; ++d ) {
+          ok &= card != drawn[ d ][ lane ];
+        }
+        if( ( ( pending >> lane ) & 1 ) && ok ) {
+          drawn[ c ][ lane ] = card;
+          pending &= ~( 1 << lane );
+        }
+      }
+    }
+    for( unsigned int lane = 0; lane < SAMPLER_LANES; ++lane ) {
+      rawCards[ c * stride + lane ] = drawn[ c ][ lane ];
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+__attribute__(( target( "avx2" ) ))
+void BoardSampler::sampleAvx2( BoardSampler& sampler, unsigned int cardsPerDraw, unsigned int rawCards[], std::size_t stride )
+{
+  __m256i s0 = _mm256_loadu_si256( (const __m256i*) sampler.state_[ 0 ] );
+  __m256i s1 = _mm256_loadu_si256( (const __m256i*) sampler.state_[ 1 ] );
+  __m256i s2 = _mm256_loadu_si256( (const __m256i*) sampler.state_[ 2 ] );
+  __m256i s3 = _mm256_loadu_si256( (const __m256i*) sampler.state_[ 3 ] );
+  const __m256i range = _mm256_set1_epi32( sampler.numberOfLiveCards_ );
+  const __m256i threshold = _mm256_set1_epi32( sampler.threshold_ );
+  const int* liveCards = (const int*) sampler.liveCards_;
+
+  __m256i drawn[ MAX_SAMPLED_CARDS ];
+  for( unsigned int c = 0; c < cardsPerDraw; ++c ) {
+    __m256i pending = _mm256_set1_epi32( -1 );
+    drawn[ c ] = _mm256_setzero_si256();
+    while( !_mm256_testz_si256( pending, pending ) ) {
+      // xoshiro128**, the multiplications by 5 and 9 as shifts and adds
+      __m256i x = _mm256_add_epi32( s1, _mm256_slli_epi32( s1, 2 ) );
+      x = _mm256_or_si256( _mm256_slli_epi32( x, 7 ), _mm256_srli_epi32( x, 25 ) );
+      __m256i random = _mm256_add_epi32( x, _mm256_slli_epi32( x, 3 ) );
+      __m256i t = _mm256_slli_epi32( s1, 9 );
+      s2 = _mm256_xor_si256( s2, s0 );
+      s3 = _mm256_xor_si256( s3, s1 );
+      s1 = _mm256_xor_si256( s1, s2 );
+      s0 = _mm256_xor_si256( s0, s3 );
+      s2 = _mm256_xor_si256( s2, t );
+      s3 = _mm256_or_si256( _mm256_slli_epi32( s3, 11 ), _mm256_srli_epi32( s3, 21 ) );
+
+      // 32 x 32 bit products of the even and the odd lanes, split in high and low halves
+      __m256i evenProduct = _mm256_mul_epu32( random, range );
+      __m256i oddProduct = _mm256_mul_epu32( _mm256_srli_epi64( random, 32 ), range );
+      __m256i high = _mm256_blend_epi32( _mm256_srli_epi64( evenProduct, 32 ), oddProduct, 0xaa );
+      __m256i low = _mm256_blend_epi32( evenProduct, _mm256_slli_epi64( oddProduct, 32 ), 0xaa );
+
+      __m256i card = _mm256_i32gather_epi32( liveCards, high, 4 );
+      __m256i ok = _mm256_cmpeq_epi32( _mm256_max_epu32( low, threshold ), low );
+      for( unsigned int d = 0; d < c; ++d ) {
+        ok = _mm256_andnot_si256( _mm256_cmpeq_epi32( card, drawn[ d ] ), ok );
+      }
+      ok = _mm256_and_si256( ok, pending );
+      drawn[ c ] = _mm256_blendv_epi8( drawn[ c ], card, ok );
+      pending = _mm256_andnot_si256( ok, pending );
+    }
+    _mm256_storeu_si256( (__m256i*) ( rawCards + c * stride ), drawn[ c ] );
+  }
+
+  _mm256_storeu_si256( (__m256i*) sampler.state_[ 0 ], s0 );
+  _mm256_storeu_si256( (__m256i*) sampler.state_[ 1 ], s1 );
+  _mm256_storeu_si256( (__m256i*) sampler.state_[ 2 ], s2 );
+  _mm256_storeu_si256( (__m256i*) sampler.state_[ 3 ], s3 );
+}
+#endif
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+void BoardSampler::sample( unsigned int cardsPerDraw, std::size_t numberOfDraws, unsigned int rawCards[] )
+{
+  if( cardsPerDraw == 0 || cardsPerDraw > MAX_SAMPLED_CARDS || cardsPerDraw > numberOfLiveCards_ ) {
+    throw std::logic_error( "A draw needs 1 to 16 cards and no more than the live cards." );
+  }
+
+  static const SampleKernel kernel = dispatchKernel< SampleKernel >( &sampleScalar, nullptr, X86_KERNEL( &sampleAvx2 ), nullptr );
+
+  std::size_t end = numberOfDraws & ~(std::size_t) ( SAMPLER_LANES - 1 );
+  for( std::size_t i = 0; i < end; i += SAMPLER_LANES ) {
+    kernel( *this, cardsPerDraw, rawCards + i, numberOfDraws );
+  }
+
+  // the last draws come from a full block of lanes, so the streams stay the same
+  if( end < numberOfDraws ) {
+    unsigned int block[ MAX_SAMPLED_CARDS * SAMPLER_LANES ];
+    kernel( *this, cardsPerDraw, block, SAMPLER_LANES );
+    for( unsigned int c = 0; c < cardsPerDraw; ++c ) {
+      for( std::size_t i = end; i < numberOfDraws; ++i ) {
+        rawCards[ c * numberOfDraws + i ] = block[ c * SAMPLER_LANES + i - end ];
+      }
+    }
+  }
+}
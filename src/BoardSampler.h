@@ -0,0 +1,48 @@
+#ifndef POKER_BOARD_SAMPLER_H
+#define POKER_BOARD_SAMPLER_H
+
+#include <cstdint>
+#include <cstddef>
+#include "CardDeck.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#define SAMPLER_LANES 8
+#define MAX_SAMPLED_CARDS 16
+
+// Deals many random draws of k cards without replacement from the cards not in a
+// dead card mask, 8 draws at a time in 8 xoshiro128** lanes. Every card is an
+// unbiased multiply and shift draw from the table of live cards; a lane whose
+// card was rejected by the bound or is a duplicate of an earlier card of its draw
+// is masked and drawn again, all lanes stepping together until none is left.
+//
+// The draws are written as Card::raw() values in the structure of arrays layout
+// of FiveCardEvaluator::evaluateBatch: card c of draw i is
+// rawCards[ c * numberOfDraws + i ]. Fixed cards, like the hole cards of a hand,
+// are filled into the first rows by the caller and the sampler is given the
+// buffer behind them.
+//
+// The AVX2 kernel and the scalar kernel step the lanes identically, so a master
+// seed and stream id give the same draws on every CPU.
+class BoardSampler {
+private:
+   std::uint32_t state_[ 4 ][ SAMPLER_LANES ];   // xoshiro128** state, word by lane
+   unsigned int liveCards_[ CARDS_IN_DECK ];      // Card::raw() values
+   unsigned int numberOfLiveCards_;
+   std::uint32_t threshold_;                      // 2^32 mod numberOfLiveCards_
+
+   typedef void ( *SampleKernel )( BoardSampler& sampler, unsigned int cardsPerDraw,
+                                   unsigned int rawCards[], std::size_t stride );
+
+   static void sampleScalar( BoardSampler& sampler, unsigned int cardsPerDraw, unsigned int rawCards[], std::size_t stride );
+   static void sampleAvx2( BoardSampler& sampler, unsigned int cardsPerDraw, unsigned int rawCards[], std::size_t stride );
+
+public:
+   BoardSampler( CardSet deadCards, std::uint64_t masterSeed, std::uint64_t streamId = 0 );
+
+   inline unsigned int numberOfLiveCards() const { return numberOfLiveCards_; }
+
+   void sample( unsigned int cardsPerDraw, std::size_t numberOfDraws, unsigned int rawCards[] );
+};
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef POKER_CARD_COMBINATIONS_H
+#define POKER_CARD_COMBINATIONS_H
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#define ANY_NUMBER_OF_HOLE_CARDS -1
+
+// Every five card subset of HoleCards hole cards followed by CommonCards common
+// cards which uses exactly HoleCardsUsed hole cards, or any number of them for
+// ANY_NUMBER_OF_HOLE_CARDS. The rows index into the hole cards followed by the
+// common cards and are built by the compiler, so evaluators can unroll over them.
+template< unsigned int HoleCards, unsigned int CommonCards, int HoleCardsUsed >
+struct CardCombinations {
+   static constexpr unsigned int holeCards = HoleCards;
+   static constexpr unsigned int commonCards = CommonCards;
+
+   template< class Visitor >
+   static constexpr unsigned int forEachRow( Visitor&& visitor )
+   {
+      const unsigned int n = HoleCards + CommonCards;
+      unsigned int count = 0;
+      for( unsigned int a = 0; a < n; ++a )
+         for( unsigned int b = a + 1; b < n; ++b )
+            for( unsigned int c = b + 1; c < n; ++c )
+               for( unsigned int d = c + 1; d < n; ++d )
+                  for( unsigned int e = d + 1; e < n; ++e ) {
+                     int used = ( a < HoleCards ) + ( b < HoleCards ) + ( c < HoleCards ) + ( d < HoleCards ) + ( e < HoleCards );
+                     if( HoleCardsUsed == ANY_NUMBER_OF_HOLE_CARDS || used == HoleCardsUsed ) {
+                        visitor( count++, a, b, c, d, e );
+                     }
+                  }
+      return count;
+   }
+
+   static constexpr unsigned int size = forEachRow( []( unsigned int, unsigned int, unsigned int, unsigned int,
+                                                        unsigned int, unsigned int ) {} );
+
+   struct Rows {
+      unsigned char cards[ size ][ 5 ];
+
+      constexpr Rows()
+        : cards()
+      {
+         forEachRow( [ this ]( unsigned int row, unsigned int a, unsigned int b, unsigned int c, unsigned int d, unsigned int e ) {
+            cards[ row ][ 0 ] = a;
+            cards[ row ][ 1 ] = b;
+            cards[ row ][ 2 ] = c;
+            cards[ row ][ 3 ] = d;
+            cards[ row ][ 4 ] = e;
+         } );
+      }
+   };
+
+   static constexpr Rows rows = Rows();
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+typedef CardCombinations< 2, 5, ANY_NUMBER_OF_HOLE_CARDS > HoldemCombinations;   // 21 rows
+typedef CardCombinations< 4, 5, 2 > OmahaCombinations;                          // 60 rows
+typedef CardCombinations< 5, 5, 2 > FiveCardOmahaCombinations;                  // 100 rows
+typedef CardCombinations< 6, 5, 2 > SixCardOmahaCombinations;                   // 150 rows
+
+#endif
@@ -6,180 +6,235 @@
 #include <memory>
 #include <map>
 #include <unistd.h>
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <immintrin.h>
+#endif
 
 #include "CardDeck.h"
+#include "CpuDispatch.h"
 
-Card::Card()
+std::string Card::toString() const
 {
+  CardRank rank = (CardRank) ( index_ >> 2 );
+  CardSuit suit = (CardSuit) ( index_ & 0x03 );
+  return ranksAsString[ rank ] + suitesAsString[ suit ];
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
-Card::Card( unsigned int index )
+Hand::Hand()
+{
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+void Hand::add( const Card& card )
 {
-   index_ = index;
-   CardRank rank = (CardRank) ( index >> 2 );
-   CardSuit suit = (CardSuit) ( index & 0x03 );
-   raw_ = primes[ rank ] | ( rank << 8 ) | ( 1 << ( suit + 12 ) ) | ( 1 << (16 + rank ) );
+  cards_.push_back( card );
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
-Card::Card( CardRank rank, CardSuit suit )
+Hand::Hand( std::initializer_list< Card > cardList )
 {
-  index_ = ( rank << 2 ) + suit;
-  raw_ = primes[ rank ] | ( rank << 8 ) | ( 1 << ( suit + 12 ) ) | ( 1 << (16 + rank ) );
+   for( Card c : cardList ) {
+      cards_.push_back( c );
+   }
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
-const std::string& Card::toString() const
+std::string Hand::toString() const
 {
-  if( asString_.empty() ) {
-    CardRank rank = (CardRank) ( index_ >> 2 );
-    CardSuit suit = (CardSuit) ( index_ & 0x03 );
-    asString_ = ranksAsString[ rank ] + suitesAsString[ suit ];
+  std::string handToString; 
+  for( const Card& card : cards() ) {
+    handToString += card.toString() + " ";
   }
 
-  return asString_;
+  return handToString;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
-Hand::Hand()
+CardSet::CardSet( const Hand& hand )
+  : mask_( 0 )
 {
+  for( const Card& card : hand.cards() ) {
+    add( card );
+  }
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
-void Hand::add( const Card& card )
-{
-  cards_.push_back( card );
+namespace {
+   typedef unsigned int ( *SelectCardKernel )( std::uint64_t mask, unsigned int n );
+
+   unsigned int selectCardScalar( std::uint64_t mask, unsigned int n )
+   {
+      for( unsigned int i = 0; i < n; ++i ) {
+         mask &= mask - 1;
+      }
+      return __builtin_ctzll( mask );
+   }
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+   __attribute__(( target( "bmi,bmi2" ) ))
+   unsigned int selectCardBmi2( std::uint64_t mask, unsigned int n )
+   {
+      return __builtin_ctzll( _pdep_u64( 1ULL << n, mask ) );
+   }
+#endif
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
-Hand::Hand( std::initializer_list< Card > cardList )
+unsigned int CardSet::selectCard( unsigned int n ) const
 {
-   for( Card c : cardList ) {
-      cards_.push_back( c );
-   }
+  static const SelectCardKernel kernel = dispatchKernel< SelectCardKernel >( &selectCardScalar, nullptr,
+                                                                            X86_KERNEL( &selectCardBmi2 ), nullptr );
+  return kernel( mask_, n );
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
-std::string Hand::toString() const
+Hand CardSet::toHand() const
 {
-  std::string handToString; 
-  for( const Card& card : cards() ) {
-    handToString += card.toString() + " ";
+  Hand hand;
+  for( std::uint64_t m = mask_; m; m &= m - 1 ) {
+    hand.add( Card( __builtin_ctzll( m ) ) );
   }
 
-  return handToString;
+  return hand;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
-unsigned int CardDeck::randomCardIndex()
+std::string CardSet::toString() const
 {
-  return distribution_( generator_ );
+  return toHand().toString();
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
-void CardDeck::generateCardsForDeck()
+// Lemire's multiply and shift: the high half of a 32 x 32 bit product is in
+// [ 0, range ), the low half tells when a draw has to be redone to stay unbiased,
+// which for at most 52 cards is less than once in 80 million draws.
+unsigned int CardDeck::randomNumber( unsigned int range )
 {
-  for( int i = 0; i < CARDS_IN_DECK; ++i ) {
-    Card c( i );
-    cardDeck_[ i ] = c;
-    lockedCards_[ i ] = false;
+  std::uint64_t product = std::uint64_t( generator_.next32() ) * range;
+  std::uint32_t low = std::uint32_t( product );
+  if( low < range ) {
+    std::uint32_t threshold = -range % range;
+    while( low < threshold ) {
+      product = std::uint64_t( generator_.next32() ) * range;
+      low = std::uint32_t( product );
+    }
   }
+  return product >> 32;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
-Card CardDeck::cardDeck_[ CARDS_IN_DECK ];
-bool CardDeck::cardsInitialized_ = false;
+CardDeck::CardDeck( DeckType deckType )
+  : CardDeck( deckType, RandomStream::randomSeed(), 0 )
+{
+}
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
-CardDeck::CardDeck()
-  : generator_( std::chrono::system_clock::now().time_since_epoch().count() ),
-    distribution_( 0, CARDS_IN_DECK - 1 )
+CardDeck::CardDeck( DeckType deckType, std::uint64_t masterSeed, std::uint64_t streamId )
+  : deckType_( deckType ),
+    generator_( masterSeed, streamId )
 {
-  if( !cardsInitialized_ ) {
-    generateCardsForDeck();
-    cardsInitialized_ = true;
-  }
-
   cleanAll();
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
-void CardDeck::clean()
+void CardDeck::cleanAll()
 {
-  for( int i = 0; i < CARDS_IN_DECK; ++i ) {
-    dealedCards_[ i ] = lockedCards_[ i ];
-  }
+  lockedCards_ = deckType_ == SHORT_DECK ? ( 1ULL << SHORT_DECK_FIRST_CARD ) - 1 : 0;
+  clean();
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
-void CardDeck::cleanAll()
+CardDeck CardDeck::split()
 {
-  for( int i = 0; i < CARDS_IN_DECK; ++i ) {
-    lockedCards_[ i ] = false;
-  }
-  clean();
+  std::uint64_t masterSeed = generator_();
+  return CardDeck( deckType_, masterSeed, generator_() );
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
 const Card& CardDeck::dealCard( const unsigned int cardIndex )
 {
-  if( dealedCards_[ cardIndex ] ) {
+  if( ( ( remainingCards_ >> cardIndex ) & 1 ) == 0 ) {
     throw std::logic_error( "Card was allready dealed." );
   }
-  dealedCards_[ cardIndex ] = true;
-  return cardDeck_[ cardIndex ];
+  remainingCards_ &= ~( 1ULL << cardIndex );
+  return cardDeck_.cards[ cardIndex ];
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
 const Card& CardDeck::dealCard()
 {
-  unsigned int cardIndex = randomCardIndex();
-  int watchdogCounter = 0;
-  while( dealedCards_[ cardIndex ] == true && watchdogCounter < 5 ) {
-    cardIndex = randomCardIndex();
-    ++watchdogCounter;
-  } 
+  return cardDeck_.cards[ dealCardIndex() ];
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
 
-  if( watchdogCounter < 5 ) {
-    return dealCard( cardIndex );
+unsigned int CardDeck::dealCards( const unsigned int numberOfCards, unsigned int cardIndices[] )
+{
+  unsigned int numberOfRemainingCards = __builtin_popcountll( remainingCards_ );
+  unsigned int numberOfDealtCards = std::min( numberOfCards, numberOfRemainingCards );
+  for( unsigned int i = 0; i < numberOfDealtCards; ++i ) {
+    unsigned int cardIndex = CardSet( remainingCards_ ).selectCard( randomNumber( numberOfRemainingCards-- ) );
+    remainingCards_ &= ~( 1ULL << cardIndex );
+    cardIndices[ i ] = cardIndex;
   }
 
-  cardIndex = ( cardIndex + 1 ) % CARDS_IN_DECK;
-  watchdogCounter = 0;
-  while( dealedCards_[ cardIndex ] == true && watchdogCounter < CARDS_IN_DECK ) {
-    cardIndex = ( cardIndex + 1 ) % CARDS_IN_DECK;
-    ++watchdogCounter;
-  } 
+  return numberOfDealtCards;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+CardSet CardDeck::dealCards( const unsigned int numberOfCards )
+{
+  if( numberOfCards > CARDS_IN_DECK || __builtin_popcountll( remainingCards_ ) < numberOfCards ) {
+    throw std::runtime_error( "No more cards left in deck." );
+  }
 
-  if( watchdogCounter >= CARDS_IN_DECK ) {
+  unsigned int cardIndices[ CARDS_IN_DECK ];
+  dealCards( numberOfCards, cardIndices );
+  CardSet cards;
+  for( unsigned int i = 0; i < numberOfCards; ++i ) {
+    cards.add( cardIndices[ i ] );
+  }
+
+  return cards;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int CardDeck::dealCardIndex()
+{
+  unsigned int cardIndex;
+  if( dealCards( 1, &cardIndex ) == 0 ) {
     throw std::runtime_error( "No more cards left in deck." );
   }
 
-  return dealCard( cardIndex );
+  return cardIndex;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
 const Card& CardDeck::lockCard( const unsigned int cardIndex )
 {
-  lockedCards_[ cardIndex ] = true;
-  return dealCard( cardIndex );
+  const Card& card = dealCard( cardIndex );
+  lockedCards_ |= 1ULL << cardIndex;
+  return card;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
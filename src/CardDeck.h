@@ -3,7 +3,10 @@
 
 #include <vector>
 #include <string>
-#include <random>
+#include <cstdint>
+#include <type_traits>
+
+#include "RandomStream.h"
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
@@ -19,6 +22,8 @@ enum HandRank {
    STRAIGHT_FLUSH
 };
 
+#define NUMBER_OF_HAND_RANKS 9
+
 
 enum CardRank {
    DEUCE = 0,
@@ -47,22 +52,32 @@ enum CardSuit {
 
 class Card {
 private:
-   static unsigned int primes[];
+   static constexpr unsigned int primes[ 13 ] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41 };
    static std::string ranksAsString[];
    static std::string suitesAsString[];
 
    unsigned int raw_;
    unsigned int index_;
-   mutable std::string asString_;
 
 public:
-   Card();
-   Card( unsigned int index );
-   Card( CardRank rank, CardSuit suit );
+   constexpr Card() : raw_( 0 ), index_( 0 ) {}
+   constexpr Card( unsigned int index ) : raw_( rawCard( index ) ), index_( index ) {}
+   constexpr Card( CardRank rank, CardSuit suit ) : Card( ( rank << 2 ) + suit ) {}
+
+   inline constexpr unsigned int raw() const { return raw_; }
+   inline constexpr unsigned int index() const { return index_; }
+   std::string toString() const;
+
+   static inline constexpr unsigned int rawCard( unsigned int index )
+   {
+      unsigned int rank = index >> 2;
+      return primes[ rank ] | ( rank << 8 ) | ( 1 << ( ( index & 0x03 ) + 12 ) ) | ( 1 << ( 16 + rank ) );
+   }
 
-   inline unsigned int raw() const { return raw_; }
-   inline unsigned int index() const { return index_; }
-   const std::string& toString() const;
+   static inline constexpr unsigned int cardIndex( unsigned int raw )
+   {
+      return ( ( ( raw >> 8 ) & 0x0f ) << 2 ) + __builtin_ctz( ( raw >> 12 ) & 0x0f );
+   }
 };
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -86,29 +101,114 @@ public:
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
+// A set of cards with one bit per Card::index(). Unlike Hand it is trivially
+// copyable and never allocates, which makes it the type for hot loops.
+class CardSet {
+private:
+   std::uint64_t mask_;
+
+public:
+   CardSet() : mask_( 0 ) {}
+   explicit CardSet( std::uint64_t mask ) : mask_( mask ) {}
+   CardSet( const Hand& hand );
+
+   inline std::uint64_t mask() const { return mask_; }
+   inline unsigned int size() const { return __builtin_popcountll( mask_ ); }
+   inline bool empty() const { return mask_ == 0; }
+   inline bool contains( unsigned int cardIndex ) const { return ( mask_ >> cardIndex ) & 1; }
+   inline bool intersects( CardSet other ) const { return ( mask_ & other.mask_ ) != 0; }
+
+   inline void add( unsigned int cardIndex ) { mask_ |= 1ULL << cardIndex; }
+   inline void add( const Card& card ) { add( card.index() ); }
+   inline void remove( unsigned int cardIndex ) { mask_ &= ~( 1ULL << cardIndex ); }
+
+   inline CardSet operator|( CardSet other ) const { return CardSet( mask_ | other.mask_ ); }
+   inline CardSet& operator|=( CardSet other ) { mask_ |= other.mask_; return *this; }
+   inline bool operator==( CardSet other ) const { return mask_ == other.mask_; }
+   inline bool operator!=( CardSet other ) const { return mask_ != other.mask_; }
+
+   // writes the card indices in ascending order, returns the number of cards
+   inline unsigned int indices( unsigned int cardIndices[] ) const
+   {
+      unsigned int n = 0;
+      for( std::uint64_t m = mask_; m; m &= m - 1 ) {
+         cardIndices[ n++ ] = __builtin_ctzll( m );
+      }
+      return n;
+   }
+
+   // index of the n-th card in ascending order, n < size()
+   unsigned int selectCard( unsigned int n ) const;
+
+   Hand toHand() const;
+   std::string toString() const;
+};
+
+static_assert( std::is_trivially_copyable< CardSet >::value, "CardSet must stay trivially copyable" );
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
 #define CARDS_IN_DECK 52
+#define CARDS_IN_SHORT_DECK 36
+#define SHORT_DECK_FIRST_CARD 16   // Card::index() of the six of clubs
+
+enum DeckType {
+   FULL_DECK = 0,   // 52 cards
+   SHORT_DECK       // 36 cards, six to ace
+};
 
+// All cards by Card::index(), built by the compiler so that decks created on
+// worker threads never race on initialization.
+struct CardDeckCards {
+   Card cards[ CARDS_IN_DECK ];
+
+   constexpr CardDeckCards()
+     : cards()
+   {
+      for( unsigned int i = 0; i < CARDS_IN_DECK; ++i ) {
+         cards[ i ] = Card( i );
+      }
+   }
+};
+
+// The cards still in the deck are one 64 bit mask by Card::index(), so a reset is
+// a single store and a card is dealt by picking the n-th remaining card for one
+// bounded random number, unbiased however few cards are left.
 class CardDeck {
 private:
-   bool dealedCards_[ CARDS_IN_DECK ];
-   bool lockedCards_[ CARDS_IN_DECK ];
-   static Card cardDeck_[ CARDS_IN_DECK ];
-   static bool cardsInitialized_;
+   std::uint64_t remainingCards_;
+   std::uint64_t lockedCards_;
+   static constexpr CardDeckCards cardDeck_ = CardDeckCards();
+   DeckType deckType_;
 
-   std::mt19937 generator_;
-   std::uniform_int_distribution< unsigned int> distribution_;
+   RandomStream generator_;
 
 private: 
-   unsigned int randomCardIndex();
-   void generateCardsForDeck();
+   unsigned int randomNumber( unsigned int range );
 
 public:
-   CardDeck();
-   void clean();
+   // A short deck keeps the deuces to fives locked, so they are never dealt. A deck
+   // given a master seed and stream id deals the same cards on every run.
+   CardDeck( DeckType deckType = FULL_DECK );
+   CardDeck( DeckType deckType, std::uint64_t masterSeed, std::uint64_t streamId );
+   inline DeckType deckType() const { return deckType_; }
+   inline CardSet remainingCards() const { return CardSet( remainingCards_ ); }
+   inline void clean() { remainingCards_ = ~lockedCards_ & ( ( 1ULL << CARDS_IN_DECK ) - 1 ); }
    void cleanAll();
 
+   // A new deck of the same type with every card back, seeded from this deck's
+   // stream. Only the stream of this deck moves on, its cards and locks are kept.
+   CardDeck split();
+
    const Card& dealCard();
    const Card& dealCard( const unsigned int cardIndex );
+   unsigned int dealCardIndex();
+   CardSet dealCards( const unsigned int numberOfCards );
+
+   // Deals up to numberOfCards card indices into cardIndices without throwing and
+   // returns how many were dealt, fewer only when the deck runs out.
+   unsigned int dealCards( const unsigned int numberOfCards, unsigned int cardIndices[] );
+
    const Card& lockCard( const unsigned int cardIndex );
    const Card& lockCard( const std::string& cardAsString );
 };
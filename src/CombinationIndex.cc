@@ -0,0 +1,73 @@
+#include <stdexcept>
+
+#include "CombinationIndex.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+CombinationIndex::CombinationIndex( CardSet deck, unsigned int numberOfCards )
+  : deck_( deck ),
+    numberOfCards_( numberOfCards )
+{
+  if( numberOfCards == 0 || numberOfCards > deck.size() ) {
+    throw std::logic_error( "A combination needs 1 card up to the cards in the deck." );
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+CombinationIndex::CombinationIndex( const CardDeck& deck, unsigned int numberOfCards )
+  : CombinationIndex( deck.remainingCards(), numberOfCards )
+{
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+std::uint64_t CombinationIndex::rank( CardSet combination ) const
+{
+  if( combination.size() != numberOfCards_ || ( combination.mask() & ~deck_.mask() ) ) {
+    throw std::logic_error( "The combination is not made of cards of the deck." );
+  }
+
+  std::uint64_t index = 0;
+  unsigned int k = 1;
+  for( std::uint64_t m = combination.mask(); m; m &= m - 1, ++k ) {
+    unsigned int position = __builtin_popcountll( deck_.mask() & ( ( m & ( ~m + 1 ) ) - 1 ) );
+    index += binomials.values[ position ][ k ];
+  }
+
+  return index;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// The greedy decoding from the highest card down: the k-th card sits at the
+// largest position p with C( p, k ) <= index. Positions are turned into cards by
+// CardSet::selectCard, PDEP on BMI2.
+CardSet CombinationIndex::unrank( std::uint64_t index ) const
+{
+  if( index >= size() ) {
+    throw std::logic_error( "Combination index out of range." );
+  }
+
+  CardSet combination;
+  unsigned int position = deck_.size();
+  for( unsigned int k = numberOfCards_; k > 0; --k ) {
+    do {
+      --position;
+    } while( binomials.values[ position ][ k ] > index );
+    index -= binomials.values[ position ][ k ];
+    combination.add( deck_.selectCard( position ) );
+  }
+
+  return combination;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+std::uint64_t CombinationIndex::splitPoint( unsigned int unit, unsigned int numberOfUnits ) const
+{
+  // size * unit / numberOfUnits without overflowing 64 bits
+  std::uint64_t quotient = size() / numberOfUnits;
+  std::uint64_t remainder = size() % numberOfUnits;
+  return quotient * unit + remainder * unit / numberOfUnits;
+}
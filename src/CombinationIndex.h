@@ -0,0 +1,96 @@
+#ifndef POKER_COMBINATION_INDEX_H
+#define POKER_COMBINATION_INDEX_H
+
+#include <cstdint>
+#include "CardDeck.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Binomial coefficients C( n, k ) for n and k up to 52, built by the compiler.
+struct BinomialTable {
+   std::uint64_t values[ CARDS_IN_DECK + 1 ][ CARDS_IN_DECK + 1 ];
+
+   constexpr BinomialTable()
+     : values()
+   {
+      for( unsigned int n = 0; n <= CARDS_IN_DECK; ++n ) {
+         values[ n ][ 0 ] = 1;
+         for( unsigned int k = 1; k <= n; ++k ) {
+            values[ n ][ k ] = values[ n - 1 ][ k - 1 ] + ( k < n ? values[ n - 1 ][ k ] : 0 );
+         }
+      }
+   }
+};
+
+inline constexpr BinomialTable binomials;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Combinatorial number system over the cards of a deck, usually the cards still
+// left in a CardDeck. A combination of k of its n cards at positions
+// p1 < p2 < .. < pk among the deck's cards has the colex index
+// C( p1, 1 ) + C( p2, 2 ) + .. + C( pk, k ), so the C( n, k ) combinations are
+// numbered 0 to C( n, k ) - 1 without gaps and any index range is a work unit
+// that can be enumerated on its own.
+class CombinationIndex {
+private:
+   CardSet deck_;
+   unsigned int numberOfCards_;   // k
+
+public:
+   CombinationIndex( CardSet deck, unsigned int numberOfCards );
+   CombinationIndex( const CardDeck& deck, unsigned int numberOfCards );
+
+   inline CardSet deck() const { return deck_; }
+   inline unsigned int numberOfCards() const { return numberOfCards_; }
+   inline std::uint64_t size() const { return binomials.values[ deck_.size() ][ numberOfCards_ ]; }
+
+   std::uint64_t rank( CardSet combination ) const;
+   CardSet unrank( std::uint64_t index ) const;
+
+   // First index of work unit unit out of numberOfUnits nearly equal ones, the
+   // last unit ends at size().
+   std::uint64_t splitPoint( unsigned int unit, unsigned int numberOfUnits ) const;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Steps through the combinations of a CombinationIndex in index order, directly
+// on the card masks: Gosper's next combination with the cards not in the deck
+// filled in, so the carry runs over them, followed by moving the freed cards to
+// the lowest cards of the deck.
+class CombinationIterator {
+private:
+   std::uint64_t deckMask_;
+   std::uint64_t cards_;
+   std::uint64_t index_;
+
+public:
+   inline CombinationIterator( const CombinationIndex& combinationIndex, std::uint64_t index )
+     : deckMask_( combinationIndex.deck().mask() ),
+       cards_( index < combinationIndex.size() ? combinationIndex.unrank( index ).mask() : 0 ),
+       index_( index )
+   {
+   }
+
+   inline CardSet cards() const { return CardSet( cards_ ); }
+   inline std::uint64_t index() const { return index_; }
+
+   // only valid while index() + 1 < size() of the CombinationIndex
+   inline void next()
+   {
+      std::uint64_t lowestCard = cards_ & ( ~cards_ + 1 );
+      std::uint64_t moved = ( ( cards_ | ~deckMask_ ) + lowestCard ) & deckMask_;
+
+      // all but one of the cards the carry ran over go to the bottom of the deck
+      std::uint64_t lowCards = deckMask_;
+      for( std::uint64_t freed = cards_ & ~moved & ( ( cards_ & ~moved ) - 1 ); freed; freed &= freed - 1 ) {
+         moved |= lowCards & ( ~lowCards + 1 );
+         lowCards &= lowCards - 1;
+      }
+      cards_ = moved;
+      ++index_;
+   }
+};
+
+#endif
@@ -0,0 +1,78 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "CpuDispatch.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+   const char* instructionSetNames[] = { "scalar", "sse4.2", "avx2", "avx512" };
+
+   InstructionSet detectInstructionSet()
+   {
+#if defined( __x86_64__ ) || defined( __i386__ )
+      __builtin_cpu_init();
+      if( __builtin_cpu_supports( "avx512f" ) && __builtin_cpu_supports( "avx512bw" ) && __builtin_cpu_supports( "avx2" )
+          && __builtin_cpu_supports( "bmi2" ) ) {
+         return AVX512;
+      }
+      if( __builtin_cpu_supports( "avx2" ) && __builtin_cpu_supports( "bmi2" ) ) {
+         return AVX2;
+      }
+      if( __builtin_cpu_supports( "sse4.2" ) && __builtin_cpu_supports( "popcnt" ) ) {
+         return SSE42;
+      }
+#endif
+      return SCALAR;
+   }
+
+   InstructionSet initializeInstructionSet()
+   {
+      InstructionSet detected = detectInstructionSet();
+      const char* requested = std::getenv( "POKER_EVALUATOR_ISA" );
+      if( requested == nullptr || *requested == '\0' ) {
+         return detected;
+      }
+
+      InstructionSet instructionSet = parseInstructionSet( requested );
+      if( instructionSet > detected ) {
+         std::cerr << "POKER_EVALUATOR_ISA=" << requested << " is not supported by this CPU, using "
+                   << instructionSetName( detected ) << std::endl;
+         return detected;
+      }
+      return instructionSet;
+   }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+InstructionSet selectedInstructionSet()
+{
+  static const InstructionSet instructionSet = initializeInstructionSet();
+  return instructionSet;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+const char* instructionSetName( InstructionSet instructionSet )
+{
+  return instructionSetNames[ instructionSet ];
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+InstructionSet parseInstructionSet( const char* name )
+{
+  for( int i = SCALAR; i <= AVX512; ++i ) {
+    if( std::strcmp( name, instructionSetNames[ i ] ) == 0 ) {
+      return (InstructionSet) i;
+    }
+  }
+  if( std::strcmp( name, "sse42" ) == 0 ) {
+    return SSE42;
+  }
+
+  std::cerr << "Unknown instruction set " << name << ", using scalar kernels" << std::endl;
+  return SCALAR;
+}
@@ -0,0 +1,43 @@
+#ifndef POKER_CPU_DISPATCH_H
+#define POKER_CPU_DISPATCH_H
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+enum InstructionSet {
+   SCALAR = 0,
+   SSE42,
+   AVX2,     // AVX2 together with BMI2
+   AVX512    // AVX-512 F and BW
+};
+
+// The widest instruction set of this CPU, or the narrower one requested by the
+// environment variable POKER_EVALUATOR_ISA ( scalar, sse4.2, avx2, avx512 ).
+// Requests for instruction sets the CPU lacks are ignored. Detected once.
+InstructionSet selectedInstructionSet();
+const char* instructionSetName( InstructionSet instructionSet );
+InstructionSet parseInstructionSet( const char* name );
+
+// The vector and BMI2 kernels are x86 code: their definitions are guarded by
+// __x86_64__ / __i386__ and dispatch sites name them through X86_KERNEL(), which
+// is nullptr on other CPUs, so those build and run the scalar kernels only.
+#if defined( __x86_64__ ) || defined( __i386__ )
+#define X86_KERNEL( kernel ) kernel
+#else
+#define X86_KERNEL( kernel ) nullptr
+#endif
+
+// Picks the widest kernel not above the selected instruction set. Pass nullptr
+// for instruction sets without a kernel of their own.
+template< class Kernel >
+Kernel dispatchKernel( Kernel scalar, Kernel sse42, Kernel avx2, Kernel avx512 )
+{
+   Kernel kernels[] = { scalar, sse42, avx2, avx512 };
+   for( int i = selectedInstructionSet(); i > SCALAR; --i ) {
+      if( kernels[ i ] ) {
+         return kernels[ i ];
+      }
+   }
+   return scalar;
+}
+
+#endif
@@ -0,0 +1,225 @@
+#include <stdexcept>
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include "EquityEnumerator.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+   const unsigned char bitCounts[ 16 ] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+   // a subset of the four suits of one rank, bit s for suit s, spread to one
+   // nibble per suit for the suit counter and to 16 bits per suit for the masks
+   inline unsigned int suitCounterStep( unsigned int suits )
+   {
+      return ( suits & 1 ) | ( ( suits & 2 ) << 3 ) | ( ( suits & 4 ) << 6 ) | ( ( suits & 8 ) << 9 );
+   }
+
+   inline std::uint64_t suitMaskStep( unsigned int suits )
+   {
+      return ( suits & 1 ) | ( std::uint64_t( suits & 2 ) << 15 ) | ( std::uint64_t( suits & 4 ) << 30 )
+        | ( std::uint64_t( suits & 8 ) << 45 );
+   }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+EquityEnumerator::KnownCards::KnownCards( CardSet cards )
+  : rankCounts(), hashTails(), suitCounter( 0 ), suitMasks()
+{
+  for( std::uint64_t m = cards.mask(); m; m &= m - 1 ) {
+    unsigned int cardIndex = __builtin_ctzll( m );
+    ++rankCounts[ cardIndex >> 2 ];
+    suitCounter += 1 << ( ( cardIndex & 0x03 ) << 2 );
+    suitMasks[ cardIndex & 0x03 ] |= 1 << ( cardIndex >> 2 );
+  }
+
+  // hashTails[ r ][ k ]: the hash terms of ranks r and above with k of the seven cards left
+  for( int rank = NUMBER_OF_RANKS - 1; rank >= 0; --rank ) {
+    for( unsigned int k = rankCounts[ rank ]; k < 8; ++k ) {
+      hashTails[ rank ][ k ] = FiveOfSevenCardEvaluator::quinaryOffsets[ rank ][ k ][ rankCounts[ rank ] ]
+        + hashTails[ rank + 1 ][ k - rankCounts[ rank ] ];
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// 0 without a flush, the board's suits and masks are added to the known cards'
+inline unsigned int EquityEnumerator::KnownCards::flushValue( unsigned int boardSuitCounter, std::uint64_t boardSuitMasks ) const
+{
+  unsigned int flushSuits = ( suitCounter + boardSuitCounter + 0x3333 ) & 0x8888;
+  if( flushSuits == 0 ) {
+    return 0;
+  }
+  unsigned int suit = __builtin_ctz( flushSuits ) >> 2;
+  return FiveOfSevenCardEvaluator::flushes[ suitMasks[ suit ] | ( ( boardSuitMasks >> ( suit << 4 ) ) & 0x1fff ) ];
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// One work unit. The state of a node is passed down by value: the cards chosen so
+// far, per hand the hash of the ranks done and the cards of its seven left for
+// the ranks to come, and the suits of the chosen cards.
+struct EquityEnumerator::Enumeration {
+   const KnownCards* hands;
+   std::uint64_t deck;
+   unsigned int numberOfCards;
+   unsigned int cardsFrom[ NUMBER_OF_RANKS + 1 ];   // cards of the deck at ranks r and above
+   EquityCounts counts;
+
+   inline void chooseSuits( unsigned int rank, unsigned int suits, unsigned int cardsChosen,
+                            unsigned int hash1, unsigned int cardsLeft1, unsigned int hash2, unsigned int cardsLeft2,
+                            unsigned int suitCounter, std::uint64_t suitMasks )
+   {
+      cardsChosen += bitCounts[ suits ];
+      if( cardsChosen > numberOfCards ) {
+         return;
+      }
+
+      unsigned int count1 = bitCounts[ suits ] + hands[ 0 ].rankCounts[ rank ];
+      unsigned int count2 = bitCounts[ suits ] + hands[ 1 ].rankCounts[ rank ];
+      hash1 += FiveOfSevenCardEvaluator::quinaryOffsets[ rank ][ cardsLeft1 ][ count1 ];
+      hash2 += FiveOfSevenCardEvaluator::quinaryOffsets[ rank ][ cardsLeft2 ][ count2 ];
+      cardsLeft1 -= count1;
+      cardsLeft2 -= count2;
+      suitCounter += suitCounterStep( suits );
+      suitMasks |= suitMaskStep( suits ) << rank;
+
+      if( cardsChosen == numberOfCards ) {
+         unsigned int value1 = hands[ 0 ].flushValue( suitCounter, suitMasks );
+         unsigned int value2 = hands[ 1 ].flushValue( suitCounter, suitMasks );
+         if( value1 == 0 ) {
+            value1 = FiveOfSevenCardEvaluator::ranks7[ hash1 + hands[ 0 ].hashTails[ rank + 1 ][ cardsLeft1 ] ];
+         }
+         if( value2 == 0 ) {
+            value2 = FiveOfSevenCardEvaluator::ranks7[ hash2 + hands[ 1 ].hashTails[ rank + 1 ][ cardsLeft2 ] ];
+         }
+         counts.wins += value1 < value2;
+         counts.ties += value1 == value2;
+         counts.losses += value1 > value2;
+      }
+      else if( cardsFrom[ rank + 1 ] >= numberOfCards - cardsChosen ) {
+         chooseRank( rank + 1, cardsChosen, hash1, cardsLeft1, hash2, cardsLeft2, suitCounter, suitMasks );
+      }
+   }
+
+   void chooseRank( unsigned int rank, unsigned int cardsChosen,
+                    unsigned int hash1, unsigned int cardsLeft1, unsigned int hash2, unsigned int cardsLeft2,
+                    unsigned int suitCounter, std::uint64_t suitMasks )
+   {
+      unsigned int available = ( deck >> ( rank << 2 ) ) & 0x0f;
+      unsigned int suits = 0;
+      do {
+         chooseSuits( rank, suits, cardsChosen, hash1, cardsLeft1, hash2, cardsLeft2, suitCounter, suitMasks );
+         suits = ( suits - available ) & available;
+      } while( suits );
+   }
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+EquityEnumerator::EquityEnumerator()
+{
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// All boards whose lowest missing card is lowestCard.
+EquityCounts EquityEnumerator::enumerateUnit( const KnownCards hands[ 2 ], CardSet deck, unsigned int numberOfCards,
+                                              unsigned int lowestCard )
+{
+  Enumeration enumeration;
+  enumeration.hands = hands;
+  enumeration.deck = deck.mask() & ~( ( 2ULL << lowestCard ) - 1 );
+  enumeration.numberOfCards = numberOfCards;
+  enumeration.counts = EquityCounts{ 0, 0, 0 };
+  enumeration.cardsFrom[ NUMBER_OF_RANKS ] = 0;
+  for( int rank = NUMBER_OF_RANKS - 1; rank >= 0; --rank ) {
+    enumeration.cardsFrom[ rank ] = enumeration.cardsFrom[ rank + 1 ] + bitCounts[ ( enumeration.deck >> ( rank << 2 ) ) & 0x0f ];
+  }
+
+  // the ranks below the lowest card only hold known cards
+  unsigned int lowestRank = lowestCard >> 2;
+  unsigned int hash1 = 0;
+  unsigned int hash2 = 0;
+  unsigned int cardsLeft1 = 7;
+  unsigned int cardsLeft2 = 7;
+  for( unsigned int rank = 0; rank < lowestRank; ++rank ) {
+    hash1 += FiveOfSevenCardEvaluator::quinaryOffsets[ rank ][ cardsLeft1 ][ hands[ 0 ].rankCounts[ rank ] ];
+    hash2 += FiveOfSevenCardEvaluator::quinaryOffsets[ rank ][ cardsLeft2 ][ hands[ 1 ].rankCounts[ rank ] ];
+    cardsLeft1 -= hands[ 0 ].rankCounts[ rank ];
+    cardsLeft2 -= hands[ 1 ].rankCounts[ rank ];
+  }
+
+  unsigned int lowestSuit = 1 << ( lowestCard & 0x03 );
+  unsigned int available = ( enumeration.deck >> ( lowestRank << 2 ) ) & 0x0f;
+  unsigned int suits = 0;
+  do {
+    enumeration.chooseSuits( lowestRank, suits | lowestSuit, 0, hash1, cardsLeft1, hash2, cardsLeft2, 0, 0 );
+    suits = ( suits - available ) & available;
+  } while( suits );
+
+  return enumeration.counts;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+EquityCounts EquityEnumerator::enumerate( CardSet holeCards1, CardSet holeCards2, CardSet commonCards,
+                                          unsigned int numberOfThreads ) const
+{
+  unsigned int numberOfCommonCards = commonCards.size();
+  if( holeCards1.size() != 2 || holeCards2.size() != 2
+      || ( numberOfCommonCards != 0 && ( numberOfCommonCards < 3 || numberOfCommonCards > 5 ) ) ) {
+    throw std::logic_error( "Hold'em needs 2 hole cards and 0, 3, 4 or 5 common cards." );
+  }
+  if( ( holeCards1 | holeCards2 | commonCards ).size() != 4 + numberOfCommonCards ) {
+    throw std::logic_error( "The same card is given twice." );
+  }
+
+  KnownCards hands[ 2 ] = { KnownCards( holeCards1 | commonCards ), KnownCards( holeCards2 | commonCards ) };
+  CardSet deck( ( ( 1ULL << CARDS_IN_DECK ) - 1 ) & ~( holeCards1 | holeCards2 | commonCards ).mask() );
+  unsigned int numberOfCards = 5 - numberOfCommonCards;
+
+  if( numberOfCards == 0 ) {
+    unsigned int value1 = evaluator_.evaluate( holeCards1 | commonCards );
+    unsigned int value2 = evaluator_.evaluate( holeCards2 | commonCards );
+    return EquityCounts{ value1 < value2, value1 == value2, value1 > value2 };
+  }
+
+  unsigned int lowestCards[ CARDS_IN_DECK ];
+  unsigned int numberOfUnits = deck.indices( lowestCards );
+  std::atomic< unsigned int > nextUnit( 0 );
+  auto work = [ & ]() {
+    EquityCounts counts = { 0, 0, 0 };
+    for( unsigned int unit = nextUnit++; unit < numberOfUnits; unit = nextUnit++ ) {
+      EquityCounts unitCounts = enumerateUnit( hands, deck, numberOfCards, lowestCards[ unit ] );
+      counts.wins += unitCounts.wins;
+      counts.ties += unitCounts.ties;
+      counts.losses += unitCounts.losses;
+    }
+    return counts;
+  };
+
+  if( numberOfThreads == 0 ) {
+    numberOfThreads = std::max( 1u, std::thread::hardware_concurrency() );
+  }
+  std::vector< std::future< EquityCounts > > futureCounts;
+  for( unsigned int i = 1; i < numberOfThreads; ++i ) {
+    futureCounts.push_back( std::async( std::launch::async, work ) );
+  }
+
+  EquityCounts counts = work();
+  for( auto& f : futureCounts ) {
+    EquityCounts threadCounts = f.get();
+    counts.wins += threadCounts.wins;
+    counts.ties += threadCounts.ties;
+    counts.losses += threadCounts.losses;
+  }
+
+  return counts;
+}
@@ -0,0 +1,64 @@
+#ifndef POKER_EQUITY_ENUMERATOR_H
+#define POKER_EQUITY_ENUMERATOR_H
+
+#include <cstdint>
+#include "CardDeck.h"
+#include "FiveOfSevenCardEvaluator.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Outcomes of the first hand over all boards enumerated.
+struct EquityCounts {
+   std::uint64_t wins;
+   std::uint64_t ties;
+   std::uint64_t losses;
+
+   inline std::uint64_t boards() const { return wins + ties + losses; }
+   inline double equity() const { return ( wins + 0.5 * ties ) / boards(); }
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Exact heads up Hold'em equity: every completion of the common cards is played
+// out, C( 48, 5 ) = 1712304 boards preflop, 990 on the flop and 44 on the turn.
+//
+// Instead of hashing each board from scratch the missing cards are chosen rank
+// by rank, deuces first. The quinary hash of FiveOfSevenCardEvaluator adds one
+// term per rank, so both hands' hashes grow with the ranks chosen and every node
+// of the recursion is shared by all boards below it; a board costs two table
+// loads and a flush check. The known cards of each hand, hole and common cards
+// together, are folded into a table of hash tails for the ranks above the last
+// card chosen.
+//
+// The work is split by the lowest missing card, the units are taken from a
+// shared counter by the threads.
+class EquityEnumerator {
+private:
+   FiveOfSevenCardEvaluator evaluator_;
+
+   // the seven card hash terms and suits of one hand's known cards
+   struct KnownCards {
+      unsigned char rankCounts[ NUMBER_OF_RANKS ];
+      unsigned short hashTails[ NUMBER_OF_RANKS + 1 ][ 8 ];   // by first rank and cards left
+      unsigned int suitCounter;                               // one nibble per suit
+      unsigned int suitMasks[ 4 ];
+
+      explicit KnownCards( CardSet cards );
+      inline unsigned int flushValue( unsigned int suitCounter, std::uint64_t suitMasks ) const;
+   };
+
+   struct Enumeration;
+
+   static EquityCounts enumerateUnit( const KnownCards hands[ 2 ], CardSet deck, unsigned int numberOfCards,
+                                      unsigned int lowestCard );
+
+public:
+   EquityEnumerator();
+
+   // Counts from the point of view of holeCards1; commonCards holds 0, 3, 4 or 5
+   // cards. numberOfThreads 0 uses every hardware thread.
+   EquityCounts enumerate( CardSet holeCards1, CardSet holeCards2, CardSet commonCards = CardSet(),
+                           unsigned int numberOfThreads = 1 ) const;
+};
+
+#endif
@@ -30,53 +30,9 @@
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
-unsigned int FiveCardEvaluator::find_fast( unsigned int u ) const
-{
-    unsigned a, b, r;
-    u += 0xe91aaa35;
-    u ^= u >> 16;
-    u += u << 8;
-    u ^= u >> 4;
-    b  = (u >> 8) & 0x1ff;
-    a  = ( u + (u << 2 ) ) >> 19;
-    r  = a ^ hash_adjust[ b ];
-    return r;
-}
-
-//////////////////////////////////////////////////////////////////////////////////////////
-
 std::string FiveCardEvaluator::evaluateToString( const unsigned int val ) const
 {
-  HandRank rank = HIGH_CARD; 
-  if( val > 6185 ) {
-    rank = HIGH_CARD;        // 1277 high card
-  }
-  else if( val > 3325 ) {
-    rank = ONE_PAIR;         // 2860 one pair
-  } 
-  else if( val > 2467 ) {
-    rank = TWO_PAIR;         //  858 two pair
-  }
-  else if( val > 1609 ) {
-    rank = THREE_OF_A_KIND;  //  858 three-kind
-  }
-  else if( val > 1599 ) {
-    rank = STRAIGHT;         //   10 straights
-  }
-  else if( val > 322 )  {
-    rank = FLUSH;            // 1277 flushes
-  }
-  else if( val > 166 )  {
-    rank = FULL_HOUSE;       //  156 full house
-  }
-  else if ( val > 10 ) {
-    rank = FOUR_OF_A_KIND;   //  156 four-kind
-  }   
-  else {
-    rank = STRAIGHT_FLUSH;                   //   10 straight-flushes
-  }
-
-  return ranksAsString[ rank ];
+  return std::string( handRankName( val ) );
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -102,59 +58,142 @@ unsigned int FiveCardEvaluator::evaluate( const Hand& hand ) const
    q = q >> 16;
 
    if( f ) {
-      return flushes[ q ]; // check for flushes and straight flushes
+      return evaluateFlush( q ); // check for flushes and straight flushes
+   }
+
+   return evaluateRanks( q, v );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// best five out of five to seven cards, without any allocation
+unsigned int FiveCardEvaluator::evaluate( CardSet hand ) const
+{
+   unsigned int numberOfCards = hand.size();
+   if( numberOfCards < 5 || numberOfCards > 7 ) {
+      throw std::logic_error( "Five to seven cards are needed for evaluation." );
+   }
+
+   unsigned int rawCards[ 7 ];
+   hand.indices( rawCards );
+   for( unsigned int i = 0; i < numberOfCards; ++i ) {
+      rawCards[ i ] = Card::rawCard( rawCards[ i ] );
    }
 
-   unsigned short s = unique5[ q ];
-   if( s ) {
-      return s;
+   switch( numberOfCards ) {
+   case 5:
+      return evaluateCombinations< CardCombinations< 0, 5, ANY_NUMBER_OF_HOLE_CARDS > >( rawCards, std::make_index_sequence< 1 >() );
+   case 6:
+      return evaluateCombinations< CardCombinations< 0, 6, ANY_NUMBER_OF_HOLE_CARDS > >( rawCards, std::make_index_sequence< 6 >() );
+   default:
+      return evaluateCombinations< CardCombinations< 0, 7, ANY_NUMBER_OF_HOLE_CARDS > >( rawCards, std::make_index_sequence< 21 >() );
    }
-   
-   return hash_values[ find_fast( v ) ];
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////
+
+
+unsigned int FiveCardEvaluator::evaluateHoldemHand( const Hand& holeCards, const Hand& commonCards ) const
+{
+  return evaluateHandWithCommonCards< HoldemCombinations >( holeCards, commonCards );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int FiveCardEvaluator::evaluateHoldemHand( CardSet holeCards, CardSet commonCards ) const
+{
+  return evaluate( holeCards | commonCards );
+}
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
-unsigned int FiveCardEvaluator::evaluateHandWithCommonCards( const PermutationMatrix& permutationMatrix, 
-								  const Hand& holeCards, const Hand& commonCards ) const
+unsigned int FiveCardEvaluator::evaluateOmahaHand( const Hand& holeCards, const Hand& commonCards ) const
 {
-  unsigned int bestValue = 9999;
-
-  for( auto row : permutationMatrix ) {
-    Hand h;
-    auto indexHoleCards = row.first;
-    auto indexCommonCards = row.second;
-    for( unsigned int index : indexHoleCards ) {
-      h.add( holeCards.cards()[ index ] );
-    }
-    for( unsigned int index : indexCommonCards ) {
-      h.add( commonCards.cards()[ index ] );
-    }
-    unsigned int handValue = evaluate( h );
-    if( handValue < bestValue ) {
-      bestValue = handValue;
-    }
+  switch( holeCards.cards().size() ) {
+  case 5:
+    return evaluateHandWithCommonCards< FiveCardOmahaCombinations >( holeCards, commonCards );
+  case 6:
+    return evaluateHandWithCommonCards< SixCardOmahaCombinations >( holeCards, commonCards );
+  default:
+    return evaluateHandWithCommonCards< OmahaCombinations >( holeCards, commonCards );
   }
+}
 
-  // std::cout << holeCards.toString() << " " << commonCards.toString();
-  // std::cout << " :  " << evaluateToString( bestValue ) << " ";
-  // std::cout << " :  " << bestValue << std::endl;
-  
-  return bestValue;
+//////////////////////////////////////////////////////////////////////////////////////////
+
+BestHand FiveCardEvaluator::evaluateBestHand( CardSet hand ) const
+{
+  unsigned int handValue = evaluate( hand );
+  return BestHand{ handValue, bestFiveCards( handValue, hand ) };
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
-unsigned int FiveCardEvaluator::evaluateHoldemHand( const Hand& holeCards, const Hand& commonCards ) const
+BestHand FiveCardEvaluator::evaluateBestOmahaHand( const Hand& holeCards, const Hand& commonCards ) const
 {
-  return evaluateHandWithCommonCards( permutationHoldem, holeCards, commonCards );
+  switch( holeCards.cards().size() ) {
+  case 5:
+    return evaluateBestHandWithCommonCards< FiveCardOmahaCombinations >( holeCards, commonCards );
+  case 6:
+    return evaluateBestHandWithCommonCards< SixCardOmahaCombinations >( holeCards, commonCards );
+  default:
+    return evaluateBestHandWithCommonCards< OmahaCombinations >( holeCards, commonCards );
+  }
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
-unsigned int FiveCardEvaluator::evaluateOmahaHand( const Hand& holeCards, const Hand& commonCards ) const
+CardSet FiveCardEvaluator::bestFiveCards( unsigned int value, CardSet cards )
 {
-  return evaluateHandWithCommonCards( permutationOmaha, holeCards, commonCards );
+  unsigned int pattern = fiveCardEvaluatorTables.rankPatterns[ value ];
+  std::uint64_t mask = cards.mask();
+
+  // straight flushes and flushes: keep only the suit holding all five ranks
+  if( handRank( value ) == FLUSH || handRank( value ) == STRAIGHT_FLUSH ) {
+    for( unsigned int suit = 0; suit < 4; ++suit ) {
+      std::uint64_t suitCards = mask & ( 0x1111111111111ULL << suit );
+      bool complete = true;
+      for( int shift = 16; shift >= 0; shift -= 4 ) {
+        complete = complete && ( suitCards >> ( 4 * ( ( pattern >> shift ) & 0x0f ) ) & 0x0f );
+      }
+      if( complete ) {
+        mask = suitCards;
+        break;
+      }
+    }
+  }
+
+  // any card of the right rank will do, five cards of one suit would have been a flush
+  CardSet best;
+  for( int shift = 16; shift >= 0; shift -= 4 ) {
+    std::uint64_t rankCards = mask & ( 0x0fULL << ( 4 * ( ( pattern >> shift ) & 0x0f ) ) );
+    std::uint64_t card = rankCards & ( ~rankCards + 1 );
+    best |= CardSet( card );
+    mask &= ~card;
+  }
+  return best;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////
+
+void FiveCardEvaluator::countHandRanks( const unsigned short values[], std::size_t numberOfValues,
+                                        std::size_t histogram[ NUMBER_OF_HAND_RANKS ] )
+{
+  // four partial histograms, so runs of equal hand ranks do not serialize on one counter
+  std::size_t counts[ 4 ][ NUMBER_OF_HAND_RANKS ] = {};
+  const unsigned char* handRanks = fiveCardEvaluatorTables.handRanks;
+  std::size_t i = 0;
+  for( ; i + 4 <= numberOfValues; i += 4 ) {
+    ++counts[ 0 ][ handRanks[ values[ i ] ] ];
+    ++counts[ 1 ][ handRanks[ values[ i + 1 ] ] ];
+    ++counts[ 2 ][ handRanks[ values[ i + 2 ] ] ];
+    ++counts[ 3 ][ handRanks[ values[ i + 3 ] ] ];
+  }
+  for( ; i < numberOfValues; ++i ) {
+    ++counts[ 0 ][ handRanks[ values[ i ] ] ];
+  }
+
+  for( unsigned int rank = 0; rank < NUMBER_OF_HAND_RANKS; ++rank ) {
+    histogram[ rank ] += counts[ 0 ][ rank ] + counts[ 1 ][ rank ] + counts[ 2 ][ rank ] + counts[ 3 ][ rank ];
+  }
+}
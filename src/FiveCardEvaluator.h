@@ -3,37 +3,246 @@
 
 #include <vector>
 #include <string>
+#include <string_view>
 #include <random>
+#include <cstddef>
+#include <algorithm>
+#include <utility>
+#include <stdexcept>
 #include "CardDeck.h"
+#include "CardCombinations.h"
+#include "FiveCardEvaluatorTables.h"
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
-typedef std::vector< std::pair< std::vector< unsigned int >, std::vector< unsigned int > > >  PermutationMatrix;
+enum TableLayout {
+   SPLIT_TABLES = 0,   // flushes, unique5, hash_adjust and hash_values as four arrays
+   COMPACT_TABLES      // CompactFiveCardEvaluatorTables
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// A hand value together with the five cards that make it.
+struct BestHand {
+   unsigned int value;
+   CardSet cards;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// The ranks of a hand value by their role. Quads, trips, pairs and the two parts
+// of a full house are primary ranks, as are the top card of a straight and the
+// highest card of a flush or high card hand. All other ranks are kickers, best
+// first.
+struct DecodedHand {
+   HandRank handRank;
+   unsigned int numberOfPrimaryRanks;
+   unsigned int numberOfKickers;
+   CardRank primaryRanks[ 2 ];
+   CardRank kickers[ 4 ];
+};
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
 class FiveCardEvaluator {
 private:
-   static unsigned short hash_adjust[];
-   static unsigned short hash_values[];
-   static unsigned short unique5[];
-   static unsigned short flushes[];
-   static std::string ranksAsString[];
-   static PermutationMatrix permutationHoldem;
-   static PermutationMatrix permutationOmaha;
-   unsigned int find_fast( unsigned int u ) const;
-
-   unsigned int evaluateHandWithCommonCards( const PermutationMatrix& permutationMatrix, 
-					     const Hand& holeCards, const Hand& commonCards ) const;
-   
+   static constexpr const unsigned short* hash_adjust = fiveCardHashAdjust;
+   static constexpr const unsigned short* hash_values = fiveCardEvaluatorTables.hashValues;
+   static constexpr const unsigned short* unique5 = fiveCardEvaluatorTables.unique5;
+   static constexpr const unsigned short* flushes = fiveCardEvaluatorTables.flushes;
+   static constexpr std::string_view handRankNames[ NUMBER_OF_HAND_RANKS ] = {
+      "High Card", "One Pair", "Two Pairs", "Set", "Straight", "Flush", "Full House", "Four Of a Kind", "Straight Flush"
+   };
+   // by HandRank: position of the second primary rank in the rank pattern, 0 if
+   // there is none, and the number of kickers at the end of the pattern
+   static constexpr unsigned char secondPrimaryRank[ NUMBER_OF_HAND_RANKS ] = { 0, 0, 2, 0, 0, 0, 3, 0, 0 };
+   static constexpr unsigned char numberOfKickers[ NUMBER_OF_HAND_RANKS ] = { 4, 3, 1, 2, 0, 4, 0, 1, 0 };
+
+   TableLayout layout_;
+
+   inline unsigned int find_fast( unsigned int u ) const { return FiveCardEvaluatorTables::findFast( u ); }
+
+   template< class Combinations, std::size_t... Row >
+   unsigned int evaluateCombinations( const unsigned int rawCards[], std::index_sequence< Row... > ) const;
+
+   typedef std::size_t ( *BatchKernel )( const unsigned int rawCards[], unsigned int cardsPerHand,
+                                         std::size_t numberOfHands, unsigned short values[] );
+
+   static void evaluateBatchRange( const unsigned int rawCards[], unsigned int cardsPerHand, std::size_t numberOfHands,
+                                   std::size_t begin, unsigned short values[] );
+   static std::size_t evaluateBatchScalar( const unsigned int rawCards[], unsigned int cardsPerHand,
+                                           std::size_t numberOfHands, unsigned short values[] );
+   static std::size_t evaluateBatchSse42( const unsigned int rawCards[], unsigned int cardsPerHand,
+                                          std::size_t numberOfHands, unsigned short values[] );
+   static std::size_t evaluateBatchAvx2( const unsigned int rawCards[], unsigned int cardsPerHand,
+                                         std::size_t numberOfHands, unsigned short values[] );
+   static std::size_t evaluateBatchAvx512( const unsigned int rawCards[], unsigned int cardsPerHand,
+                                           std::size_t numberOfHands, unsigned short values[] );
 
 public:
+   FiveCardEvaluator( TableLayout layout = SPLIT_TABLES ) : layout_( layout ) {}
+
+   inline TableLayout layout() const { return layout_; }
+
    unsigned int evaluate( const Hand& hand ) const;
+   unsigned int evaluate( CardSet hand ) const;
+
+   inline unsigned int evaluateFlush( unsigned int rankBits ) const
+   {
+      if( layout_ == COMPACT_TABLES ) {
+         return CompactFiveCardEvaluatorTables::flushValue( compactFiveCardEvaluatorTables.ranks[ rankBits ] );
+      }
+      return flushes[ rankBits ];
+   }
+
+   inline unsigned int evaluateRanks( unsigned int rankBits, unsigned int primeProduct ) const
+   {
+      if( layout_ == COMPACT_TABLES ) {
+         unsigned int s = compactFiveCardEvaluatorTables.ranks[ rankBits ];
+         return s ? s : compactFiveCardEvaluatorTables.hashValues[
+            FiveCardEvaluatorTables::findFast( primeProduct, compactFiveCardEvaluatorTables.hashAdjust ) ];
+      }
+
+      unsigned short s = unique5[ rankBits ];
+      if( s ) {
+         return s;
+      }
+      return hash_values[ find_fast( primeProduct ) ];
+   }
+
+   inline unsigned int evaluate( unsigned int a, unsigned int b, unsigned int c, unsigned int d, unsigned int e ) const
+   {
+      unsigned int q = ( a | b | c | d | e ) >> 16;
+      if( a & b & c & d & e & 0xf000 ) {
+         return evaluateFlush( q );
+      }
+      return evaluateRanks( q, ( a & 0xff ) * ( b & 0xff ) * ( c & 0xff ) * ( d & 0xff ) * ( e & 0xff ) );
+   }
+
+   // Best value over all rows of a CardCombinations type, unrolled at compile time.
+   template< class Combinations >
+   unsigned int evaluateHandWithCommonCards( const Hand& holeCards, const Hand& commonCards ) const;
+   template< class Combinations >
+   BestHand evaluateBestHandWithCommonCards( const Hand& holeCards, const Hand& commonCards ) const;
    std::string evaluateToString( const Hand& hand ) const;
    std::string evaluateToString( const unsigned int val ) const;
 
+   // Table lookups on the 1..7462 value scale, no evaluator state needed.
+   static inline constexpr HandRank handRank( unsigned int value ) { return (HandRank) fiveCardEvaluatorTables.handRanks[ value ]; }
+   static inline constexpr std::string_view handRankName( HandRank handRank ) { return handRankNames[ handRank ]; }
+   static inline constexpr std::string_view handRankName( unsigned int value ) { return handRankNames[ handRank( value ) ]; }
+   static inline DecodedHand decode( unsigned int value );
+
+   // Adds the number of values of each HandRank to histogram, indexed by HandRank.
+   static void countHandRanks( const unsigned short values[], std::size_t numberOfValues,
+                               std::size_t histogram[ NUMBER_OF_HAND_RANKS ] );
+
    unsigned int evaluateHoldemHand( const Hand& holeCards, const Hand& commonCards ) const;
-   unsigned int evaluateOmahaHand( const Hand& holeCards, const Hand& commonCards ) const;
+   unsigned int evaluateHoldemHand( CardSet holeCards, CardSet commonCards ) const;
+   unsigned int evaluateOmahaHand( const Hand& holeCards, const Hand& commonCards ) const;   // 4 to 6 hole cards
+
+   // The value plus the five cards used, for 5 to 7 cards or Omaha with 4 to 6 hole cards.
+   BestHand evaluateBestHand( CardSet hand ) const;
+   BestHand evaluateBestOmahaHand( const Hand& holeCards, const Hand& commonCards ) const;
+
+   // Picks five cards out of cards that make the given value, which must be the
+   // best value of cards. The ranks come from rankPatterns, the suits from cards,
+   // so this costs a few bit operations instead of scoring the subsets again.
+   static CardSet bestFiveCards( unsigned int value, CardSet cards );
+
+   // Evaluates numberOfHands hands of 5, 6 or 7 cards at once. The cards are given
+   // as Card::raw() values in structure of arrays layout: card c of hand i is
+   // rawCards[ c * numberOfHands + i ]. The kernel is chosen by CpuDispatch and
+   // always reads its own 32 bit copies of the tables, so layout() does not apply.
+   void evaluateBatch( const unsigned int rawCards[], unsigned int cardsPerHand, std::size_t numberOfHands,
+                       unsigned short values[] ) const;
 };
 
+//////////////////////////////////////////////////////////////////////////////////////////
+
+inline DecodedHand FiveCardEvaluator::decode( unsigned int value )
+{
+   unsigned int pattern = fiveCardEvaluatorTables.rankPatterns[ value ];
+   auto rankAt = [ pattern ]( unsigned int position ) { return (CardRank) ( ( pattern >> ( 16 - 4 * position ) ) & 0x0f ); };
+
+   DecodedHand decoded;
+   decoded.handRank = handRank( value );
+   decoded.primaryRanks[ 0 ] = rankAt( 0 );
+   decoded.numberOfPrimaryRanks = 1;
+   if( secondPrimaryRank[ decoded.handRank ] ) {
+      decoded.primaryRanks[ decoded.numberOfPrimaryRanks++ ] = rankAt( secondPrimaryRank[ decoded.handRank ] );
+   }
+   decoded.numberOfKickers = numberOfKickers[ decoded.handRank ];
+   for( unsigned int i = 0; i < decoded.numberOfKickers; ++i ) {
+      decoded.kickers[ i ] = rankAt( 5 - decoded.numberOfKickers + i );
+   }
+   return decoded;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+template< class Combinations, std::size_t... Row >
+inline unsigned int FiveCardEvaluator::evaluateCombinations( const unsigned int rawCards[], std::index_sequence< Row... > ) const
+{
+   constexpr auto& cards = Combinations::rows.cards;
+   unsigned int bestValue = 9999;
+   ( ( bestValue = std::min( bestValue, evaluate( rawCards[ cards[ Row ][ 0 ] ], rawCards[ cards[ Row ][ 1 ] ],
+                                                  rawCards[ cards[ Row ][ 2 ] ], rawCards[ cards[ Row ][ 3 ] ],
+                                                  rawCards[ cards[ Row ][ 4 ] ] ) ) ), ... );
+   return bestValue;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+template< class Combinations >
+inline unsigned int FiveCardEvaluator::evaluateHandWithCommonCards( const Hand& holeCards, const Hand& commonCards ) const
+{
+   if( holeCards.cards().size() != Combinations::holeCards || commonCards.cards().size() != Combinations::commonCards ) {
+      throw std::logic_error( "Wrong number of hole cards or common cards for this game." );
+   }
+
+   unsigned int rawCards[ Combinations::holeCards + Combinations::commonCards ];
+   for( unsigned int i = 0; i < Combinations::holeCards; ++i ) {
+      rawCards[ i ] = holeCards.cards()[ i ].raw();
+   }
+   for( unsigned int i = 0; i < Combinations::commonCards; ++i ) {
+      rawCards[ Combinations::holeCards + i ] = commonCards.cards()[ i ].raw();
+   }
+
+   return evaluateCombinations< Combinations >( rawCards, std::make_index_sequence< Combinations::size >() );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+template< class Combinations >
+inline BestHand FiveCardEvaluator::evaluateBestHandWithCommonCards( const Hand& holeCards, const Hand& commonCards ) const
+{
+   if( holeCards.cards().size() != Combinations::holeCards || commonCards.cards().size() != Combinations::commonCards ) {
+      throw std::logic_error( "Wrong number of hole cards or common cards for this game." );
+   }
+
+   Card cards[ Combinations::holeCards + Combinations::commonCards ];
+   std::copy( holeCards.cards().begin(), holeCards.cards().end(), cards );
+   std::copy( commonCards.cards().begin(), commonCards.cards().end(), cards + Combinations::holeCards );
+
+   constexpr auto& rows = Combinations::rows.cards;
+   unsigned int bestValue = 9999;
+   unsigned int bestRow = 0;
+   for( unsigned int row = 0; row < Combinations::size; ++row ) {
+      unsigned int handValue = evaluate( cards[ rows[ row ][ 0 ] ].raw(), cards[ rows[ row ][ 1 ] ].raw(),
+                                         cards[ rows[ row ][ 2 ] ].raw(), cards[ rows[ row ][ 3 ] ].raw(),
+                                         cards[ rows[ row ][ 4 ] ].raw() );
+      if( handValue < bestValue ) {
+         bestValue = handValue;
+         bestRow = row;
+      }
+   }
+
+   CardSet bestCards;
+   for( unsigned int i = 0; i < 5; ++i ) {
+      bestCards.add( cards[ rows[ bestRow ][ i ] ] );
+   }
+   return BestHand{ bestValue, bestCards };
+}
+
 #endif
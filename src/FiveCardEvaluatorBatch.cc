@@ -0,0 +1,314 @@
+// Batch evaluation over structure of arrays card buffers.
+//
+// The vector kernels run the Cactus Kev / Senzee evaluation on 4 (SSE4.2), 8 (AVX2)
+// or 16 (AVX-512) hands at once: OR, AND and prime product of the cards, the
+// find_fast hash and the lookups into flushes, unique5, hash_adjust and
+// hash_values. Gathers read 32 bit lanes, so the kernels use 32 bit copies of the
+// 16 bit tables, widened by the compiler, whatever the evaluator's TableLayout.
+// Hands of 6 or 7 cards take the minimum over all 5 card subsets. The scalar
+// kernel gives identical values and handles the remainder. The kernel is picked
+// once by dispatchKernel().
+
+#include <stdexcept>
+#include <algorithm>
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <immintrin.h>
+#endif
+
+#include "FiveCardEvaluator.h"
+#include "CpuDispatch.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+   struct BatchTables {
+      unsigned int flushes[ FIVE_CARD_TABLE_SIZE ];
+      unsigned int unique5[ FIVE_CARD_TABLE_SIZE ];
+      unsigned int hashAdjust[ HASH_ADJUST_TABLE_SIZE ];
+      unsigned int hashValues[ FIVE_CARD_TABLE_SIZE ];
+
+      constexpr BatchTables()
+        : flushes(), unique5(), hashAdjust(), hashValues()
+      {
+         for( unsigned int i = 0; i < FIVE_CARD_TABLE_SIZE; ++i ) {
+            flushes[ i ] = fiveCardEvaluatorTables.flushes[ i ];
+            unique5[ i ] = fiveCardEvaluatorTables.unique5[ i ];
+            hashValues[ i ] = fiveCardEvaluatorTables.hashValues[ i ];
+         }
+         for( unsigned int i = 0; i < HASH_ADJUST_TABLE_SIZE; ++i ) {
+            hashAdjust[ i ] = fiveCardHashAdjust[ i ];
+         }
+      }
+   };
+
+   constexpr BatchTables batchTables;
+
+   // all 5 card subsets of 5, 6 and 7 cards, terminated by a row starting with 0xff
+   const unsigned char subsets5[][ 5 ] = {
+     { 0, 1, 2, 3, 4 }, { 0xff }
+   };
+
+   const unsigned char subsets6[][ 5 ] = {
+     { 0, 1, 2, 3, 4 }, { 0, 1, 2, 3, 5 }, { 0, 1, 2, 4, 5 }, { 0, 1, 3, 4, 5 }, { 0, 2, 3, 4, 5 },
+     { 1, 2, 3, 4, 5 }, { 0xff }
+   };
+
+   const unsigned char subsets7[][ 5 ] = {
+     { 0, 1, 2, 3, 4 }, { 0, 1, 2, 3, 5 }, { 0, 1, 2, 3, 6 }, { 0, 1, 2, 4, 5 }, { 0, 1, 2, 4, 6 },
+     { 0, 1, 2, 5, 6 }, { 0, 1, 3, 4, 5 }, { 0, 1, 3, 4, 6 }, { 0, 1, 3, 5, 6 }, { 0, 1, 4, 5, 6 },
+     { 0, 2, 3, 4, 5 }, { 0, 2, 3, 4, 6 }, { 0, 2, 3, 5, 6 }, { 0, 2, 4, 5, 6 }, { 0, 3, 4, 5, 6 },
+     { 1, 2, 3, 4, 5 }, { 1, 2, 3, 4, 6 }, { 1, 2, 3, 5, 6 }, { 1, 2, 4, 5, 6 }, { 1, 3, 4, 5, 6 },
+     { 2, 3, 4, 5, 6 }, { 0xff }
+   };
+
+   const unsigned char ( *subsetsForCards( unsigned int cardsPerHand ) )[ 5 ]
+   {
+      switch( cardsPerHand ) {
+      case 5: return subsets5;
+      case 6: return subsets6;
+      case 7: return subsets7;
+      default: throw std::logic_error( "Five to seven cards are needed for evaluation." );
+      }
+   }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+void FiveCardEvaluator::evaluateBatchRange( const unsigned int rawCards[], unsigned int cardsPerHand,
+                                            std::size_t numberOfHands, std::size_t begin, unsigned short values[] )
+{
+  FiveCardEvaluator evaluator;
+  const unsigned char ( *subsets )[ 5 ] = subsetsForCards( cardsPerHand );
+
+  for( std::size_t i = begin; i < numberOfHands; ++i ) {
+    unsigned int bestValue = 9999;
+    for( const unsigned char* subset = subsets[ 0 ]; subset[ 0 ] != 0xff; subset += 5 ) {
+      unsigned int q = 0;
+      unsigned int f = 0xf000;
+      unsigned int v = 1;
+      for( int k = 0; k < 5; ++k ) {
+        unsigned int rawCard = rawCards[ subset[ k ] * numberOfHands + i ];
+        q |= rawCard;
+        f &= rawCard;
+        v *= rawCard & 0xff;
+      }
+      unsigned int handValue = f ? flushes[ q >> 16 ] : evaluator.evaluateRanks( q >> 16, v );
+      if( handValue < bestValue ) {
+        bestValue = handValue;
+      }
+    }
+    values[ i ] = bestValue;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+std::size_t FiveCardEvaluator::evaluateBatchScalar( const unsigned int rawCards[], unsigned int cardsPerHand,
+                                                    std::size_t numberOfHands, unsigned short values[] )
+{
+  evaluateBatchRange( rawCards, cardsPerHand, numberOfHands, 0, values );
+  return numberOfHands;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+namespace {
+   __attribute__(( target( "sse4.2" ) ))
+   inline __m128i gather4( const unsigned int table[], __m128i index )
+   {
+      return _mm_setr_epi32( table[ _mm_extract_epi32( index, 0 ) ], table[ _mm_extract_epi32( index, 1 ) ],
+                             table[ _mm_extract_epi32( index, 2 ) ], table[ _mm_extract_epi32( index, 3 ) ] );
+   }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+__attribute__(( target( "sse4.2" ) ))
+std::size_t FiveCardEvaluator::evaluateBatchSse42( const unsigned int rawCards[], unsigned int cardsPerHand,
+                                                   std::size_t numberOfHands, unsigned short values[] )
+{
+  const unsigned char ( *subsets )[ 5 ] = subsetsForCards( cardsPerHand );
+
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i primeMask = _mm_set1_epi32( 0xff );
+  const __m128i suitMask = _mm_set1_epi32( 0xf000 );
+
+  std::size_t end = numberOfHands & ~(std::size_t) 3;
+  for( std::size_t i = 0; i < end; i += 4 ) {
+    __m128i cards[ 7 ];
+    for( unsigned int c = 0; c < cardsPerHand; ++c ) {
+      cards[ c ] = _mm_loadu_si128( (const __m128i*) ( rawCards + c * numberOfHands + i ) );
+    }
+
+    __m128i bestValue = _mm_set1_epi32( 9999 );
+    for( const unsigned char* subset = subsets[ 0 ]; subset[ 0 ] != 0xff; subset += 5 ) {
+      __m128i c0 = cards[ subset[ 0 ] ], c1 = cards[ subset[ 1 ] ], c2 = cards[ subset[ 2 ] ];
+      __m128i c3 = cards[ subset[ 3 ] ], c4 = cards[ subset[ 4 ] ];
+
+      __m128i q = _mm_or_si128( _mm_or_si128( _mm_or_si128( c0, c1 ), _mm_or_si128( c2, c3 ) ), c4 );
+      __m128i f = _mm_and_si128( _mm_and_si128( _mm_and_si128( c0, c1 ), _mm_and_si128( c2, c3 ) ),
+                                 _mm_and_si128( c4, suitMask ) );
+      __m128i v = _mm_mullo_epi32( _mm_mullo_epi32( _mm_and_si128( c0, primeMask ), _mm_and_si128( c1, primeMask ) ),
+                                   _mm_mullo_epi32( _mm_and_si128( c2, primeMask ), _mm_and_si128( c3, primeMask ) ) );
+      v = _mm_mullo_epi32( v, _mm_and_si128( c4, primeMask ) );
+      q = _mm_srli_epi32( q, 16 );
+
+      __m128i flushValue = gather4( batchTables.flushes, q );
+      __m128i uniqueValue = gather4( batchTables.unique5, q );
+
+      // find_fast
+      __m128i u = _mm_add_epi32( v, _mm_set1_epi32( 0xe91aaa35 ) );
+      u = _mm_xor_si128( u, _mm_srli_epi32( u, 16 ) );
+      u = _mm_add_epi32( u, _mm_slli_epi32( u, 8 ) );
+      u = _mm_xor_si128( u, _mm_srli_epi32( u, 4 ) );
+      __m128i b = _mm_and_si128( _mm_srli_epi32( u, 8 ), _mm_set1_epi32( 0x1ff ) );
+      __m128i a = _mm_srli_epi32( _mm_add_epi32( u, _mm_slli_epi32( u, 2 ) ), 19 );
+      __m128i r = _mm_xor_si128( a, gather4( batchTables.hashAdjust, b ) );
+      __m128i handValue = gather4( batchTables.hashValues, r );
+
+      handValue = _mm_blendv_epi8( uniqueValue, handValue, _mm_cmpeq_epi32( uniqueValue, zero ) );
+      handValue = _mm_blendv_epi8( flushValue, handValue, _mm_cmpeq_epi32( f, zero ) );
+      bestValue = _mm_min_epu32( bestValue, handValue );
+    }
+
+    _mm_storel_epi64( (__m128i*) ( values + i ), _mm_packus_epi32( bestValue, bestValue ) );
+  }
+
+  return end;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+__attribute__(( target( "avx2" ) ))
+std::size_t FiveCardEvaluator::evaluateBatchAvx2( const unsigned int rawCards[], unsigned int cardsPerHand,
+                                                  std::size_t numberOfHands, unsigned short values[] )
+{
+  const unsigned char ( *subsets )[ 5 ] = subsetsForCards( cardsPerHand );
+  const int* flushTable = (const int*) batchTables.flushes;
+  const int* uniqueTable = (const int*) batchTables.unique5;
+  const int* adjustTable = (const int*) batchTables.hashAdjust;
+  const int* valueTable = (const int*) batchTables.hashValues;
+
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i primeMask = _mm256_set1_epi32( 0xff );
+  const __m256i suitMask = _mm256_set1_epi32( 0xf000 );
+
+  std::size_t end = numberOfHands & ~(std::size_t) 7;
+  for( std::size_t i = 0; i < end; i += 8 ) {
+    __m256i cards[ 7 ];
+    for( unsigned int c = 0; c < cardsPerHand; ++c ) {
+      cards[ c ] = _mm256_loadu_si256( (const __m256i*) ( rawCards + c * numberOfHands + i ) );
+    }
+
+    __m256i bestValue = _mm256_set1_epi32( 9999 );
+    for( const unsigned char* subset = subsets[ 0 ]; subset[ 0 ] != 0xff; subset += 5 ) {
+      __m256i c0 = cards[ subset[ 0 ] ], c1 = cards[ subset[ 1 ] ], c2 = cards[ subset[ 2 ] ];
+      __m256i c3 = cards[ subset[ 3 ] ], c4 = cards[ subset[ 4 ] ];
+
+      __m256i q = _mm256_or_si256( _mm256_or_si256( _mm256_or_si256( c0, c1 ), _mm256_or_si256( c2, c3 ) ), c4 );
+      __m256i f = _mm256_and_si256( _mm256_and_si256( _mm256_and_si256( c0, c1 ), _mm256_and_si256( c2, c3 ) ),
+                                    _mm256_and_si256( c4, suitMask ) );
+      __m256i v = _mm256_mullo_epi32( _mm256_mullo_epi32( _mm256_and_si256( c0, primeMask ), _mm256_and_si256( c1, primeMask ) ),
+                                      _mm256_mullo_epi32( _mm256_and_si256( c2, primeMask ), _mm256_and_si256( c3, primeMask ) ) );
+      v = _mm256_mullo_epi32( v, _mm256_and_si256( c4, primeMask ) );
+      q = _mm256_srli_epi32( q, 16 );
+
+      __m256i flushValue = _mm256_i32gather_epi32( flushTable, q, 4 );
+      __m256i uniqueValue = _mm256_i32gather_epi32( uniqueTable, q, 4 );
+
+      // find_fast
+      __m256i u = _mm256_add_epi32( v, _mm256_set1_epi32( 0xe91aaa35 ) );
+      u = _mm256_xor_si256( u, _mm256_srli_epi32( u, 16 ) );
+      u = _mm256_add_epi32( u, _mm256_slli_epi32( u, 8 ) );
+      u = _mm256_xor_si256( u, _mm256_srli_epi32( u, 4 ) );
+      __m256i b = _mm256_and_si256( _mm256_srli_epi32( u, 8 ), _mm256_set1_epi32( 0x1ff ) );
+      __m256i a = _mm256_srli_epi32( _mm256_add_epi32( u, _mm256_slli_epi32( u, 2 ) ), 19 );
+      __m256i r = _mm256_xor_si256( a, _mm256_i32gather_epi32( adjustTable, b, 4 ) );
+      __m256i handValue = _mm256_i32gather_epi32( valueTable, r, 4 );
+
+      handValue = _mm256_blendv_epi8( uniqueValue, handValue, _mm256_cmpeq_epi32( uniqueValue, zero ) );
+      handValue = _mm256_blendv_epi8( flushValue, handValue, _mm256_cmpeq_epi32( f, zero ) );
+      bestValue = _mm256_min_epu32( bestValue, handValue );
+    }
+
+    // the values fit into 16 bits, pack them into the low half
+    __m256i packed = _mm256_packus_epi32( bestValue, bestValue );
+    packed = _mm256_permute4x64_epi64( packed, 0x08 );
+    _mm_storeu_si128( (__m128i*) ( values + i ), _mm256_castsi256_si128( packed ) );
+  }
+
+  return end;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+__attribute__(( target( "avx512f" ) ))
+std::size_t FiveCardEvaluator::evaluateBatchAvx512( const unsigned int rawCards[], unsigned int cardsPerHand,
+                                                    std::size_t numberOfHands, unsigned short values[] )
+{
+  const unsigned char ( *subsets )[ 5 ] = subsetsForCards( cardsPerHand );
+
+  // the masked forms avoid false uninitialized warnings in the gcc intrinsic headers
+  const __mmask16 all = 0xffff;
+  const __m512i zero = _mm512_setzero_si512();
+  const __m512i primeMask = _mm512_set1_epi32( 0xff );
+  const __m512i suitMask = _mm512_set1_epi32( 0xf000 );
+
+  std::size_t end = numberOfHands & ~(std::size_t) 15;
+  for( std::size_t i = 0; i < end; i += 16 ) {
+    __m512i cards[ 7 ];
+    for( unsigned int c = 0; c < cardsPerHand; ++c ) {
+      cards[ c ] = _mm512_loadu_si512( rawCards + c * numberOfHands + i );
+    }
+
+    __m512i bestValue = _mm512_set1_epi32( 9999 );
+    for( const unsigned char* subset = subsets[ 0 ]; subset[ 0 ] != 0xff; subset += 5 ) {
+      __m512i c0 = cards[ subset[ 0 ] ], c1 = cards[ subset[ 1 ] ], c2 = cards[ subset[ 2 ] ];
+      __m512i c3 = cards[ subset[ 3 ] ], c4 = cards[ subset[ 4 ] ];
+
+      __m512i q = _mm512_or_si512( _mm512_or_si512( _mm512_or_si512( c0, c1 ), _mm512_or_si512( c2, c3 ) ), c4 );
+      __m512i f = _mm512_and_si512( _mm512_and_si512( _mm512_and_si512( c0, c1 ), _mm512_and_si512( c2, c3 ) ),
+                                    _mm512_and_si512( c4, suitMask ) );
+      __m512i v = _mm512_mullo_epi32( _mm512_mullo_epi32( _mm512_and_si512( c0, primeMask ), _mm512_and_si512( c1, primeMask ) ),
+                                      _mm512_mullo_epi32( _mm512_and_si512( c2, primeMask ), _mm512_and_si512( c3, primeMask ) ) );
+      v = _mm512_mullo_epi32( v, _mm512_and_si512( c4, primeMask ) );
+      q = _mm512_maskz_srli_epi32( all, q, 16 );
+
+      __m512i flushValue = _mm512_mask_i32gather_epi32( zero, all, q, batchTables.flushes, 4 );
+      __m512i uniqueValue = _mm512_mask_i32gather_epi32( zero, all, q, batchTables.unique5, 4 );
+
+      // find_fast
+      __m512i u = _mm512_add_epi32( v, _mm512_set1_epi32( 0xe91aaa35 ) );
+      u = _mm512_xor_si512( u, _mm512_maskz_srli_epi32( all, u, 16 ) );
+      u = _mm512_add_epi32( u, _mm512_maskz_slli_epi32( all, u, 8 ) );
+      u = _mm512_xor_si512( u, _mm512_maskz_srli_epi32( all, u, 4 ) );
+      __m512i b = _mm512_and_si512( _mm512_maskz_srli_epi32( all, u, 8 ), _mm512_set1_epi32( 0x1ff ) );
+      __m512i a = _mm512_maskz_srli_epi32( all, _mm512_add_epi32( u, _mm512_maskz_slli_epi32( all, u, 2 ) ), 19 );
+      __m512i r = _mm512_xor_si512( a, _mm512_mask_i32gather_epi32( zero, all, b, batchTables.hashAdjust, 4 ) );
+      __m512i handValue = _mm512_mask_i32gather_epi32( zero, all, r, batchTables.hashValues, 4 );
+
+      handValue = _mm512_mask_blend_epi32( _mm512_cmpeq_epi32_mask( uniqueValue, zero ), uniqueValue, handValue );
+      handValue = _mm512_mask_blend_epi32( _mm512_cmpneq_epi32_mask( f, zero ), handValue, flushValue );
+      bestValue = _mm512_maskz_min_epu32( all, bestValue, handValue );
+    }
+
+    _mm256_storeu_si256( (__m256i*) ( values + i ), _mm512_maskz_cvtepi32_epi16( all, bestValue ) );
+  }
+
+  return end;
+}
+#endif
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+void FiveCardEvaluator::evaluateBatch( const unsigned int rawCards[], unsigned int cardsPerHand,
+                                       std::size_t numberOfHands, unsigned short values[] ) const
+{
+  static const BatchKernel kernel = dispatchKernel< BatchKernel >( &evaluateBatchScalar, X86_KERNEL( &evaluateBatchSse42 ),
+                                                                   X86_KERNEL( &evaluateBatchAvx2 ),
+                                                                   X86_KERNEL( &evaluateBatchAvx512 ) );
+
+  std::size_t begin = kernel( rawCards, cardsPerHand, numberOfHands, values );
+  evaluateBatchRange( rawCards, cardsPerHand, numberOfHands, begin, values );
+}
@@ -0,0 +1,284 @@
+#ifndef POKER_FIVE_CARD_EVALUATOR_TABLES_H
+#define POKER_FIVE_CARD_EVALUATOR_TABLES_H
+
+#include "CardDeck.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#define FIVE_CARD_TABLE_SIZE 8192
+#define HASH_ADJUST_TABLE_SIZE 512
+#define NUMBER_OF_HAND_VALUES 7462
+
+// Seeds of Paul D. Senzee's perfect hash over the prime products of the 4888 five
+// card rank multisets with a pair or more. They were found by a search, so they
+// stay data; everything else below is derived from them by the compiler.
+inline constexpr unsigned short fiveCardHashAdjust[ HASH_ADJUST_TABLE_SIZE ] = {
+      0, 5628, 7017, 1298, 2918, 2442, 8070, 6383, 6383, 7425, 2442, 5628, 8044, 7425, 3155, 6383,
+   2918, 7452, 1533, 6849, 5586, 7452, 7452, 1533, 2209, 6029, 2794, 3509, 7992, 7733, 7452,  131,
+   6029, 4491, 1814, 7452, 6110, 3155, 7077, 6675,  532, 1334, 7555, 5325, 3056, 1403, 1403, 3969,
+   4491, 1403, 7592,  522, 8070, 1403,    0, 1905, 3584, 2918,  922, 3304, 6675,    0, 7622, 7017,
+   3210, 2139, 1403, 5225,    0, 3969, 7992, 5743, 5499, 5499, 5345, 7452,  522,  305, 3056, 7017,
+   7017, 2139, 1338, 3056, 7452, 1403, 6799, 3204, 3290, 4099, 1814, 2191, 4099, 5743, 1570, 1334,
+   7363, 1905,    0, 6799, 4400, 1480, 6029, 1905,    0, 7525, 2028, 2794,  131, 7646, 3155, 4986,
+   1858, 2442, 7992, 1607, 3584, 4986,  706, 6029, 5345, 7622, 6322, 5196, 1905, 6847,  218, 1785,
+      0, 4099, 2981, 6849, 4751, 3950, 7733, 3056, 5499, 4055, 6849, 1533,  131, 5196, 2918, 3879,
+   5325, 2794, 6029,    0,    0,  322, 7452, 6178, 2918, 2320, 6675, 3056, 6675, 1533, 6029, 1428,
+   2280, 2171, 6788, 7452, 3325,  107, 4262,  311, 5562, 7857, 6110, 2139, 4942, 4600, 1905,    0,
+   3083, 5345, 7452, 6675,    0, 6112, 4099, 7017, 1338, 6799, 2918, 1232, 3584,  522, 6029, 5325,
+   1403, 6759, 6849,  508, 6675, 2987, 7745, 6870,  896, 7452, 1232, 4400,   12, 2981, 3850, 4491,
+   6849,    0, 6675,  747, 4491, 7525, 6675, 7452, 7992, 6921, 7323, 6849, 3056, 1199, 2139, 6029,
+   6029,  190, 4351, 7891, 4400, 7134, 1533, 1194, 3950, 6675, 5345, 6383, 7622,  131, 1905, 2883,
+   6383, 1533, 5345, 2794, 4303, 1403,    0, 1338, 2794,  992, 4871, 6383, 4099, 2794, 3889, 6184,
+   3304, 1905, 6383, 3950, 3056,  522, 1810, 3975, 7622, 7452,  522, 6799, 5866, 7084, 7622, 6528,
+   2798, 7452, 1810, 7907,  642, 5345, 1905, 6849, 6675, 7745, 2918, 4751, 3229, 2139, 6029, 5207,
+   6601, 2139, 7452, 5890, 1428, 5628, 7622, 2139, 3146, 2400,  578,  941, 7672, 1814, 3210, 1533,
+   4491,   12, 2918, 1900, 7425, 2794, 2987, 3465, 1377, 3822, 3969, 3210,  859, 5499, 6878, 1377,
+   3056, 4027, 8065, 8065, 5207, 4400, 4303, 3210, 3210,    0, 6675,  357, 5628, 5512, 1905, 3452,
+   1403, 7646,  859, 6788, 3210, 2139,  378, 5663, 7733,  870,    0, 4491, 4813, 2110,  578, 2139,
+   3056, 4099, 1905, 1298, 4672, 2191, 3950, 5499, 3969, 4974, 6323, 6029, 7414, 6383,    0, 4974,
+   3210,  795, 4099,  131, 5345, 5345, 6576, 1810, 1621, 4400, 2918, 1905, 2442, 2679, 6322, 7452,
+   2110, 1403, 6383, 2653, 5132, 6856, 7841, 2794, 6110, 2028, 6675, 7425, 6999, 7441, 6029,  183,
+   6675, 4400,  859, 1403, 2794, 5985, 5345, 1533,  322, 4400, 1227, 5890, 4474, 4491, 3574, 8166,
+   6849, 7086, 5345, 5345, 5459, 3584, 6675, 3969, 7579, 8044, 2295, 2577, 1480, 5743, 3304, 5499,
+    330, 4303, 6863, 3822, 4600, 4751, 5628, 3822, 2918, 6675, 2400, 6663, 1403, 6849, 6029, 3145,
+   6110, 3210,  747, 3229, 3056, 2918, 7733,  330, 4055, 7322, 5628, 2987, 3056, 1905, 2903,  669,
+   5325, 2845, 4099, 5225, 6283, 4099, 5000,  642, 4055, 5345, 8034, 2918, 1041, 5769, 7051, 1538,
+   2918, 3366,  608, 4303, 3921,    0, 2918, 1905,  218, 6687, 5963,  859, 3083, 2987,  896, 5056,
+   1905, 2918, 4415, 7966, 7646, 2883, 5628, 7017, 8029, 6528, 4474, 6322, 5562, 6669, 4610, 7006
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Cactus Kev's hand values, 1 for a royal flush down to 7462 for 7-5-4-3-2,
+// generated in that order:
+//   flushes     flushes and straight flushes by the 13 bit rank mask
+//   unique5     straights and high cards by the rank mask
+//   hashValues  all hands with a pair or more by find_fast of the prime product
+// handRanks and rankPatterns map each value back to its HandRank and its five
+// ranks, 4 bits per rank with the most significant card in bits 16..19 (e.g.
+// K-K-K-9-9 or 5-4-3-2-A for the wheel).
+struct FiveCardEvaluatorTables {
+   unsigned short flushes[ FIVE_CARD_TABLE_SIZE ];
+   unsigned short unique5[ FIVE_CARD_TABLE_SIZE ];
+   unsigned short hashValues[ FIVE_CARD_TABLE_SIZE ];
+   unsigned char handRanks[ NUMBER_OF_HAND_VALUES + 1 ];
+   unsigned int rankPatterns[ NUMBER_OF_HAND_VALUES + 1 ];
+
+   static constexpr unsigned int findFast( unsigned int u, const unsigned short hashAdjust[] = fiveCardHashAdjust )
+   {
+      u += 0xe91aaa35;
+      u ^= u >> 16;
+      u += u << 8;
+      u ^= u >> 4;
+      unsigned int b = ( u >> 8 ) & 0x1ff;
+      unsigned int a = ( u + ( u << 2 ) ) >> 19;
+      return a ^ hashAdjust[ b ];
+   }
+
+   static constexpr unsigned int prime( unsigned int rank ) { return Card::rawCard( rank << 2 ) & 0xff; }
+
+   static constexpr unsigned int primeProduct( unsigned int rankBits )
+   {
+      unsigned int product = 1;
+      for( unsigned int rank = 0; rank < 13; ++rank ) {
+         if( rankBits & ( 1 << rank ) ) {
+            product *= prime( rank );
+         }
+      }
+      return product;
+   }
+
+   // straights from ace high down to the wheel
+   static constexpr unsigned int straight( unsigned int i ) { return i < 9 ? 0x1f00 >> i : 0x100f; }
+
+   static constexpr bool isStraight( unsigned int rankBits )
+   {
+      for( unsigned int i = 0; i < 10; ++i ) {
+         if( rankBits == straight( i ) ) {
+            return true;
+         }
+      }
+      return false;
+   }
+
+   // appends the ranks of rankBits, highest first, to a rank pattern
+   static constexpr unsigned int appendRanks( unsigned int pattern, unsigned int rankBits )
+   {
+      for( int rank = 12; rank >= 0; --rank ) {
+         if( rankBits & ( 1 << rank ) ) {
+            pattern = ( pattern << 4 ) | rank;
+         }
+      }
+      return pattern;
+   }
+
+   static constexpr unsigned int repeatRank( unsigned int rank, unsigned int n )
+   {
+      unsigned int pattern = 0;
+      for( unsigned int i = 0; i < n; ++i ) {
+         pattern = ( pattern << 4 ) | rank;
+      }
+      return pattern;
+   }
+
+   static constexpr unsigned int straightPattern( unsigned int i ) { return i < 9 ? appendRanks( 0, straight( i ) ) : 0x3210c; }
+
+   // rank masks of one to three kickers, best first, not using the excluded ranks
+   template< class Visitor >
+   static constexpr void forEachKickers( unsigned int n, unsigned int excluded, Visitor&& visitor )
+   {
+      for( int a = 12; a >= 0; --a ) {
+         if( excluded & ( 1 << a ) ) {
+            continue;
+         }
+         if( n == 1 ) {
+            visitor( 1u << a );
+            continue;
+         }
+         for( int b = a - 1; b >= 0; --b ) {
+            if( excluded & ( 1 << b ) ) {
+               continue;
+            }
+            if( n == 2 ) {
+               visitor( ( 1u << a ) | ( 1u << b ) );
+               continue;
+            }
+            for( int c = b - 1; c >= 0; --c ) {
+               if( !( excluded & ( 1 << c ) ) ) {
+                  visitor( ( 1u << a ) | ( 1u << b ) | ( 1u << c ) );
+               }
+            }
+         }
+      }
+   }
+
+   // all five card rank masks, best first
+   template< class Visitor >
+   static constexpr void forEachFiveRanks( Visitor&& visitor )
+   {
+      for( int rankBits = 0x1f00; rankBits > 0; --rankBits ) {
+         if( __builtin_popcount( rankBits ) == 5 ) {
+            visitor( rankBits );
+         }
+      }
+   }
+
+   constexpr FiveCardEvaluatorTables()
+     : flushes(), unique5(), hashValues(), handRanks(), rankPatterns()
+   {
+      unsigned int value = 1;
+      HandRank handRank = STRAIGHT_FLUSH;
+      auto nextValue = [ & ]( unsigned int pattern ) {
+         handRanks[ value ] = handRank;
+         rankPatterns[ value ] = pattern;
+         return value++;
+      };
+
+      for( unsigned int i = 0; i < 10; ++i ) {
+         flushes[ straight( i ) ] = nextValue( straightPattern( i ) );
+      }
+      handRank = FOUR_OF_A_KIND;
+      for( int quads = 12; quads >= 0; --quads ) {
+         forEachKickers( 1, 1 << quads, [ & ]( unsigned int kicker ) {
+            unsigned int p = prime( quads );
+            hashValues[ findFast( p * p * p * p * primeProduct( kicker ) ) ] = nextValue( appendRanks( repeatRank( quads, 4 ), kicker ) );
+         } );
+      }
+      handRank = FULL_HOUSE;
+      for( int trips = 12; trips >= 0; --trips ) {
+         forEachKickers( 1, 1 << trips, [ & ]( unsigned int pair ) {
+            unsigned int p = prime( trips );
+            unsigned int q = primeProduct( pair );
+            unsigned int pattern = ( repeatRank( trips, 3 ) << 8 ) | repeatRank( __builtin_ctz( pair ), 2 );
+            hashValues[ findFast( p * p * p * q * q ) ] = nextValue( pattern );
+         } );
+      }
+      handRank = FLUSH;
+      forEachFiveRanks( [ & ]( unsigned int rankBits ) {
+         if( !isStraight( rankBits ) ) {
+            flushes[ rankBits ] = nextValue( appendRanks( 0, rankBits ) );
+         }
+      } );
+      handRank = STRAIGHT;
+      for( unsigned int i = 0; i < 10; ++i ) {
+         unique5[ straight( i ) ] = nextValue( straightPattern( i ) );
+      }
+      handRank = THREE_OF_A_KIND;
+      for( int trips = 12; trips >= 0; --trips ) {
+         forEachKickers( 2, 1 << trips, [ & ]( unsigned int kickers ) {
+            unsigned int p = prime( trips );
+            hashValues[ findFast( p * p * p * primeProduct( kickers ) ) ] = nextValue( appendRanks( repeatRank( trips, 3 ), kickers ) );
+         } );
+      }
+      handRank = TWO_PAIR;
+      for( int highPair = 12; highPair >= 0; --highPair ) {
+         for( int lowPair = highPair - 1; lowPair >= 0; --lowPair ) {
+            forEachKickers( 1, ( 1 << highPair ) | ( 1 << lowPair ), [ & ]( unsigned int kicker ) {
+               unsigned int p = prime( highPair );
+               unsigned int q = prime( lowPair );
+               unsigned int pattern = ( repeatRank( highPair, 2 ) << 8 ) | repeatRank( lowPair, 2 );
+               hashValues[ findFast( p * p * q * q * primeProduct( kicker ) ) ] = nextValue( appendRanks( pattern, kicker ) );
+            } );
+         }
+      }
+      handRank = ONE_PAIR;
+      for( int pair = 12; pair >= 0; --pair ) {
+         forEachKickers( 3, 1 << pair, [ & ]( unsigned int kickers ) {
+            unsigned int p = prime( pair );
+            hashValues[ findFast( p * p * primeProduct( kickers ) ) ] = nextValue( appendRanks( repeatRank( pair, 2 ), kickers ) );
+         } );
+      }
+      handRank = HIGH_CARD;
+      forEachFiveRanks( [ & ]( unsigned int rankBits ) {
+         if( !isStraight( rankBits ) ) {
+            unique5[ rankBits ] = nextValue( appendRanks( 0, rankBits ) );
+         }
+      } );
+   }
+};
+
+inline constexpr FiveCardEvaluatorTables fiveCardEvaluatorTables;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#define COMPACT_RANK_TABLE_SIZE 7968    // rank masks up to A-K-Q-J-T, padded to a cache line
+#define STRAIGHT_FLUSH_OFFSET 1599      // straight value minus straight flush value
+#define FLUSH_OFFSET 5863               // high card value minus flush value
+
+// The same tables in one cache line aligned block of 33 KB instead of 49 KB.
+// flushes is folded into unique5: a flush ranks exactly like the high card hand
+// with the same ranks and a straight flush like the straight, so one load of
+// ranks[] serves both and the flush value is a subtraction. hashAdjust sits
+// between ranks and hashValues to keep all of it on as few pages as possible.
+// hashValues keeps its full 8192 entries: findFast XORs a 13 bit hash with a 13
+// bit adjustment, and its 4888 keys land all over 0..8190, so the table has no
+// unused tail to trim without a new perfect hash. Interleaving hashAdjust into
+// it would need 512 free slots at fixed places and saves nothing either.
+struct alignas( 64 ) CompactFiveCardEvaluatorTables {
+   unsigned short ranks[ COMPACT_RANK_TABLE_SIZE ];
+   unsigned short hashAdjust[ HASH_ADJUST_TABLE_SIZE ];
+   unsigned short hashValues[ FIVE_CARD_TABLE_SIZE ];
+
+   constexpr CompactFiveCardEvaluatorTables()
+     : ranks(), hashAdjust(), hashValues()
+   {
+      for( unsigned int i = 0; i < COMPACT_RANK_TABLE_SIZE; ++i ) {
+         ranks[ i ] = fiveCardEvaluatorTables.unique5[ i ];
+      }
+      for( unsigned int i = 0; i < HASH_ADJUST_TABLE_SIZE; ++i ) {
+         hashAdjust[ i ] = fiveCardHashAdjust[ i ];
+      }
+      for( unsigned int i = 0; i < FIVE_CARD_TABLE_SIZE; ++i ) {
+         hashValues[ i ] = fiveCardEvaluatorTables.hashValues[ i ];
+      }
+   }
+
+   static constexpr unsigned int flushValue( unsigned int rankValue )
+   {
+      return rankValue - ( rankValue > 1609 ? FLUSH_OFFSET : STRAIGHT_FLUSH_OFFSET );
+   }
+};
+
+inline constexpr CompactFiveCardEvaluatorTables compactFiveCardEvaluatorTables;
+
+#endif
@@ -0,0 +1,702 @@
+// Single pass evaluator for five, six and seven card hands.
+//
+// Flushes: with up to seven cards at most one suit can hold five or more cards and
+// no quads or full house can beat it, so the rank mask of that suit alone decides.
+// All other hands only depend on the multiset of ranks. The 6175, 18395 and 49205
+// possible rank multisets of 5, 6 and 7 cards are numbered by a quinary (base
+// five, fixed sum) perfect hash, with one table per number of cards.
+//
+// Both tables are derived once from FiveCardEvaluator::evaluate, so the values
+// are exactly those of the best five card subset.
+
+#include <stdexcept>
+#include <functional>
+#include <algorithm>
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <immintrin.h>
+#endif
+
+#include "FiveCardEvaluator.h"
+#include "FiveOfSevenCardEvaluator.h"
+#include "CpuDispatch.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+void ShowdownResult::settle( unsigned int numberOfSeats, bool lowerIsBetter )
+{
+  unsigned int bestValue = values[ 0 ];
+  for( unsigned int seat = 1; seat < numberOfSeats; ++seat ) {
+    bestValue = lowerIsBetter ? std::min( bestValue, (unsigned int) values[ seat ] )
+                              : std::max( bestValue, (unsigned int) values[ seat ] );
+  }
+
+  winners = 0;
+  for( unsigned int seat = 0; seat < numberOfSeats; ++seat ) {
+    winners |= ( values[ seat ] == bestValue ) << seat;
+  }
+  numberOfWinners = __builtin_popcount( winners );
+
+  float share = 1.0f / numberOfWinners;
+  for( unsigned int seat = 0; seat < numberOfSeats; ++seat ) {
+    shares[ seat ] = ( ( winners >> seat ) & 1 ) ? share : 0.0f;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+   typedef void ( *ShowdownBlockKernel )( const unsigned short heroValues[], const unsigned short opponentValues[],
+                                          unsigned int numberOfOpponents, unsigned int tiedWins[] );
+
+   void settleShowdownBlockScalar( const unsigned short heroValues[], const unsigned short opponentValues[],
+                                   unsigned int numberOfOpponents, unsigned int tiedWins[] )
+   {
+      for( unsigned int i = 0; i < SHOWDOWN_BLOCK_SIZE; ++i ) {
+         unsigned int bestValue = 0xffff;
+         unsigned int ties = 0;
+         for( unsigned int j = 0; j < numberOfOpponents; ++j ) {
+            unsigned int value = opponentValues[ j * SHOWDOWN_BLOCK_SIZE + i ];
+            bestValue = std::min( bestValue, value );
+            ties += value == heroValues[ i ];
+         }
+         if( bestValue >= heroValues[ i ] ) {
+            ++tiedWins[ ties ];
+         }
+      }
+   }
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+   // The vector kernels keep one 16 bit counter per lane and tie count: a lane
+   // adds one to counters[ t ] when the hero is not beaten and t opponents have
+   // the same value. A block gives each lane at most 128 trials, so the counters
+   // are summed up only at the end.
+   inline void addLaneCounters( const unsigned short counters[], unsigned int numberOfLanes, unsigned int numberOfOpponents,
+                                unsigned int tiedWins[] )
+   {
+      for( unsigned int t = 0; t <= numberOfOpponents; ++t ) {
+         for( unsigned int lane = 0; lane < numberOfLanes; ++lane ) {
+            tiedWins[ t ] += counters[ t * numberOfLanes + lane ];
+         }
+      }
+   }
+
+   __attribute__(( target( "sse4.2" ) ))
+   void settleShowdownBlockSse42( const unsigned short heroValues[], const unsigned short opponentValues[],
+                                  unsigned int numberOfOpponents, unsigned int tiedWins[] )
+   {
+      __m128i counters[ MAX_SEATS ];
+      for( unsigned int t = 0; t <= numberOfOpponents; ++t ) {
+         counters[ t ] = _mm_setzero_si128();
+      }
+
+      for( unsigned int i = 0; i < SHOWDOWN_BLOCK_SIZE; i += 8 ) {
+         __m128i hero = _mm_loadu_si128( (const __m128i*) ( heroValues + i ) );
+         __m128i best = _mm_set1_epi16( -1 );
+         __m128i ties = _mm_setzero_si128();
+         for( unsigned int j = 0; j < numberOfOpponents; ++j ) {
+            __m128i value = _mm_loadu_si128( (const __m128i*) ( opponentValues + j * SHOWDOWN_BLOCK_SIZE + i ) );
+            best = _mm_min_epu16( best, value );
+            ties = _mm_sub_epi16( ties, _mm_cmpeq_epi16( value, hero ) );
+         }
+         __m128i won = _mm_cmpeq_epi16( _mm_max_epu16( best, hero ), best );
+         for( unsigned int t = 0; t <= numberOfOpponents; ++t ) {
+            __m128i tiedWon = _mm_and_si128( won, _mm_cmpeq_epi16( ties, _mm_set1_epi16( t ) ) );
+            counters[ t ] = _mm_sub_epi16( counters[ t ], tiedWon );
+         }
+      }
+
+      unsigned short laneCounters[ MAX_SEATS * 8 ];
+      for( unsigned int t = 0; t <= numberOfOpponents; ++t ) {
+         _mm_storeu_si128( (__m128i*) ( laneCounters + t * 8 ), counters[ t ] );
+      }
+      addLaneCounters( laneCounters, 8, numberOfOpponents, tiedWins );
+   }
+
+   __attribute__(( target( "avx2" ) ))
+   void settleShowdownBlockAvx2( const unsigned short heroValues[], const unsigned short opponentValues[],
+                                 unsigned int numberOfOpponents, unsigned int tiedWins[] )
+   {
+      __m256i counters[ MAX_SEATS ];
+      for( unsigned int t = 0; t <= numberOfOpponents; ++t ) {
+         counters[ t ] = _mm256_setzero_si256();
+      }
+
+      for( unsigned int i = 0; i < SHOWDOWN_BLOCK_SIZE; i += 16 ) {
+         __m256i hero = _mm256_loadu_si256( (const __m256i*) ( heroValues + i ) );
+         __m256i best = _mm256_set1_epi16( -1 );
+         __m256i ties = _mm256_setzero_si256();
+         for( unsigned int j = 0; j < numberOfOpponents; ++j ) {
+            __m256i value = _mm256_loadu_si256( (const __m256i*) ( opponentValues + j * SHOWDOWN_BLOCK_SIZE + i ) );
+            best = _mm256_min_epu16( best, value );
+            ties = _mm256_sub_epi16( ties, _mm256_cmpeq_epi16( value, hero ) );
+         }
+         __m256i won = _mm256_cmpeq_epi16( _mm256_max_epu16( best, hero ), best );
+         for( unsigned int t = 0; t <= numberOfOpponents; ++t ) {
+            __m256i tiedWon = _mm256_and_si256( won, _mm256_cmpeq_epi16( ties, _mm256_set1_epi16( t ) ) );
+            counters[ t ] = _mm256_sub_epi16( counters[ t ], tiedWon );
+         }
+      }
+
+      unsigned short laneCounters[ MAX_SEATS * 16 ];
+      for( unsigned int t = 0; t <= numberOfOpponents; ++t ) {
+         _mm256_storeu_si256( (__m256i*) ( laneCounters + t * 16 ), counters[ t ] );
+      }
+      addLaneCounters( laneCounters, 16, numberOfOpponents, tiedWins );
+   }
+
+   __attribute__(( target( "avx512f,avx512bw" ) ))
+   void settleShowdownBlockAvx512( const unsigned short heroValues[], const unsigned short opponentValues[],
+                                   unsigned int numberOfOpponents, unsigned int tiedWins[] )
+   {
+      const __m512i one = _mm512_set1_epi16( 1 );
+      __m512i counters[ MAX_SEATS ];
+      for( unsigned int t = 0; t <= numberOfOpponents; ++t ) {
+         counters[ t ] = _mm512_setzero_si512();
+      }
+
+      for( unsigned int i = 0; i < SHOWDOWN_BLOCK_SIZE; i += 32 ) {
+         __m512i hero = _mm512_loadu_si512( (const void*) ( heroValues + i ) );
+         __m512i best = _mm512_set1_epi16( -1 );
+         __m512i ties = _mm512_setzero_si512();
+         for( unsigned int j = 0; j < numberOfOpponents; ++j ) {
+            __m512i value = _mm512_loadu_si512( (const void*) ( opponentValues + j * SHOWDOWN_BLOCK_SIZE + i ) );
+            best = _mm512_min_epu16( best, value );
+            ties = _mm512_mask_add_epi16( ties, _mm512_cmpeq_epi16_mask( value, hero ), ties, one );
+         }
+         __mmask32 won = _mm512_cmpge_epu16_mask( best, hero );
+         for( unsigned int t = 0; t <= numberOfOpponents; ++t ) {
+            __mmask32 tiedWon = _mm512_mask_cmpeq_epi16_mask( won, ties, _mm512_set1_epi16( t ) );
+            counters[ t ] = _mm512_mask_add_epi16( counters[ t ], tiedWon, counters[ t ], one );
+         }
+      }
+
+      unsigned short laneCounters[ MAX_SEATS * 32 ];
+      for( unsigned int t = 0; t <= numberOfOpponents; ++t ) {
+         _mm512_storeu_si512( (void*) ( laneCounters + t * 32 ), counters[ t ] );
+      }
+      addLaneCounters( laneCounters, 32, numberOfOpponents, tiedWins );
+   }
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+void settleShowdownBlock( const unsigned short heroValues[], const unsigned short opponentValues[],
+                          unsigned int numberOfOpponents, unsigned int tiedWins[ MAX_SEATS ] )
+{
+  static const ShowdownBlockKernel kernel = dispatchKernel< ShowdownBlockKernel >( &settleShowdownBlockScalar,
+                                                                                  X86_KERNEL( &settleShowdownBlockSse42 ),
+                                                                                  X86_KERNEL( &settleShowdownBlockAvx2 ),
+                                                                                  X86_KERNEL( &settleShowdownBlockAvx512 ) );
+  if( numberOfOpponents >= MAX_SEATS ) {
+    throw std::logic_error( "A showdown block needs at most 9 opponents." );
+  }
+
+  for( unsigned int t = 0; t < MAX_SEATS; ++t ) {
+    tiedWins[ t ] = 0;
+  }
+  kernel( heroValues, opponentValues, numberOfOpponents, tiedWins );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+unsigned short FiveOfSevenCardEvaluator::flushes[ FLUSH_TABLE_SIZE ];
+unsigned short FiveOfSevenCardEvaluator::ranks5[ RANK_TABLE_SIZE_5 ];
+unsigned short FiveOfSevenCardEvaluator::ranks6[ RANK_TABLE_SIZE_6 ];
+unsigned short FiveOfSevenCardEvaluator::ranks7[ RANK_TABLE_SIZE_7 ];
+unsigned int FiveOfSevenCardEvaluator::quinaryOffsets[ NUMBER_OF_RANKS ][ 8 ][ 5 ];
+std::once_flag FiveOfSevenCardEvaluator::tablesInitialized_;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+   void forEachRankMultiset( unsigned char rankCounts[], unsigned int rank, unsigned int cardsLeft,
+                             const std::function< void( const unsigned char[] ) >& callback )
+   {
+      if( rank == NUMBER_OF_RANKS ) {
+         if( cardsLeft == 0 ) {
+            callback( rankCounts );
+         }
+         return;
+      }
+
+      for( unsigned int count = 0; count <= 4 && count <= cardsLeft; ++count ) {
+         rankCounts[ rank ] = count;
+         forEachRankMultiset( rankCounts, rank + 1, cardsLeft - count, callback );
+      }
+      rankCounts[ rank ] = 0;
+   }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int FiveOfSevenCardEvaluator::quinaryHash( const unsigned char rankCounts[], unsigned int numberOfCards )
+{
+  unsigned int hash = 0;
+  for( unsigned int rank = 0; rank < NUMBER_OF_RANKS && numberOfCards; ++rank ) {
+    hash += quinaryOffsets[ rank ][ numberOfCards ][ rankCounts[ rank ] ];
+    numberOfCards -= rankCounts[ rank ];
+  }
+
+  return hash;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+void FiveOfSevenCardEvaluator::generateTables()
+{
+  // sequences[ n ][ k ]: number of ways to spread k cards over n ranks, at most 4 per rank
+  unsigned int sequences[ NUMBER_OF_RANKS + 1 ][ 8 ] = { { 1 } };
+  for( unsigned int n = 1; n <= NUMBER_OF_RANKS; ++n ) {
+    for( unsigned int k = 0; k < 8; ++k ) {
+      for( unsigned int count = 0; count <= 4 && count <= k; ++count ) {
+        sequences[ n ][ k ] += sequences[ n - 1 ][ k - count ];
+      }
+    }
+  }
+
+  for( unsigned int rank = 0; rank < NUMBER_OF_RANKS; ++rank ) {
+    for( unsigned int k = 0; k < 8; ++k ) {
+      unsigned int offset = 0;
+      for( unsigned int count = 0; count < 5; ++count ) {
+        quinaryOffsets[ rank ][ k ][ count ] = offset;
+        if( count <= k ) {
+          offset += sequences[ NUMBER_OF_RANKS - 1 - rank ][ k - count ];
+        }
+      }
+    }
+  }
+
+  FiveCardEvaluator evaluator;
+
+  for( unsigned int mask = 0; mask < FLUSH_TABLE_SIZE; ++mask ) {
+    int bits = __builtin_popcount( mask );
+    if( bits < 5 ) {
+      flushes[ mask ] = 0;
+    }
+    else if( bits == 5 ) {
+      Hand h;
+      for( unsigned int rank = 0; rank < NUMBER_OF_RANKS; ++rank ) {
+        if( mask & ( 1 << rank ) ) {
+          h.add( Card( (CardRank) rank, SPADE ) );
+        }
+      }
+      flushes[ mask ] = evaluator.evaluate( h );
+    }
+    else {
+      unsigned short bestValue = 9999;
+      for( unsigned int rank = 0; rank < NUMBER_OF_RANKS; ++rank ) {
+        if( ( mask & ( 1 << rank ) ) && flushes[ mask & ~( 1 << rank ) ] < bestValue ) {
+          bestValue = flushes[ mask & ~( 1 << rank ) ];
+        }
+      }
+      flushes[ mask ] = bestValue;
+    }
+  }
+
+  // Five cards are evaluated with suits dealt round robin, so they never form a
+  // flush. Six and seven cards take the best hand left after removing one card.
+  unsigned char rankCounts[ NUMBER_OF_RANKS ] = { 0 };
+
+  forEachRankMultiset( rankCounts, 0, 5, [&]( const unsigned char counts[] ) {
+      Hand h;
+      unsigned int cardCounter = 0;
+      for( unsigned int rank = 0; rank < NUMBER_OF_RANKS; ++rank ) {
+        for( unsigned int i = 0; i < counts[ rank ]; ++i ) {
+          h.add( Card( (CardRank) rank, (CardSuit) ( cardCounter++ % 4 ) ) );
+        }
+      }
+      ranks5[ quinaryHash( counts, 5 ) ] = evaluator.evaluate( h );
+    } );
+
+  auto reduce = []( const unsigned char counts[], unsigned int numberOfCards,
+                    const unsigned short smallerTable[] ) {
+    unsigned char smaller[ NUMBER_OF_RANKS ];
+    unsigned short bestValue = 9999;
+    for( unsigned int rank = 0; rank < NUMBER_OF_RANKS; ++rank ) {
+      if( counts[ rank ] ) {
+        std::copy( counts, counts + NUMBER_OF_RANKS, smaller );
+        --smaller[ rank ];
+        unsigned short value = smallerTable[ quinaryHash( smaller, numberOfCards - 1 ) ];
+        if( value < bestValue ) {
+          bestValue = value;
+        }
+      }
+    }
+    return bestValue;
+  };
+
+  forEachRankMultiset( rankCounts, 0, 6, [&]( const unsigned char counts[] ) {
+      ranks6[ quinaryHash( counts, 6 ) ] = reduce( counts, 6, ranks5 );
+    } );
+
+  forEachRankMultiset( rankCounts, 0, 7, [&]( const unsigned char counts[] ) {
+      ranks7[ quinaryHash( counts, 7 ) ] = reduce( counts, 7, ranks6 );
+    } );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+FiveOfSevenCardEvaluator::FiveOfSevenCardEvaluator()
+{
+  std::call_once( tablesInitialized_, generateTables );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+const unsigned short* FiveOfSevenCardEvaluator::rankTable( unsigned int numberOfCards )
+{
+  switch( numberOfCards ) {
+  case 5:
+    return ranks5;
+  case 6:
+    return ranks6;
+  default:
+    return ranks7;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int FiveOfSevenCardEvaluator::evaluate( const unsigned int cardIndices[], unsigned int numberOfCards ) const
+{
+  unsigned char rankCounts[ NUMBER_OF_RANKS ] = { 0 };
+  unsigned int suitMasks[ 4 ] = { 0, 0, 0, 0 };
+  unsigned int suitCounter = 0;
+
+  for( unsigned int i = 0; i < numberOfCards; ++i ) {
+    unsigned int rank = cardIndices[ i ] >> 2;
+    unsigned int suit = cardIndices[ i ] & 0x03;
+    ++rankCounts[ rank ];
+    suitMasks[ suit ] |= 1 << rank;
+    suitCounter += 1 << ( suit << 2 );
+  }
+
+  // one nibble per suit, adding 3 sets the nibble's high bit for five or more cards
+  unsigned int flushSuits = ( suitCounter + 0x3333 ) & 0x8888;
+  if( flushSuits ) {
+    return flushes[ suitMasks[ __builtin_ctz( flushSuits ) >> 2 ] ];
+  }
+
+  return rankTable( numberOfCards )[ quinaryHash( rankCounts, numberOfCards ) ];
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int FiveOfSevenCardEvaluator::evaluate( const unsigned int cardIndices[ 7 ] ) const
+{
+  return evaluate( cardIndices, 7 );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int FiveOfSevenCardEvaluator::evaluate( const Hand& hand ) const
+{
+  unsigned int numberOfCards = hand.cards().size();
+  if( numberOfCards < 5 || numberOfCards > 7 ) {
+    throw std::logic_error( "Five to seven cards are needed for evaluation." );
+  }
+
+  unsigned int cardIndices[ 7 ];
+  for( unsigned int i = 0; i < numberOfCards; ++i ) {
+    cardIndices[ i ] = hand.cards()[ i ].index();
+  }
+
+  return evaluate( cardIndices, numberOfCards );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int FiveOfSevenCardEvaluator::evaluateHoldemHand( const Hand& holeCards, const Hand& commonCards ) const
+{
+  unsigned int numberOfCommonCards = commonCards.cards().size();
+  if( holeCards.cards().size() != 2 || numberOfCommonCards < 3 || numberOfCommonCards > 5 ) {
+    throw std::logic_error( "Hold'em needs 2 hole cards and 3 to 5 common cards." );
+  }
+
+  unsigned int cardIndices[ 7 ] = { holeCards.cards()[ 0 ].index(), holeCards.cards()[ 1 ].index() };
+  for( unsigned int i = 0; i < numberOfCommonCards; ++i ) {
+    cardIndices[ 2 + i ] = commonCards.cards()[ i ].index();
+  }
+
+  return evaluate( cardIndices, 2 + numberOfCommonCards );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int FiveOfSevenCardEvaluator::evaluate( CardSet hand ) const
+{
+  unsigned int numberOfCards = hand.size();
+  if( numberOfCards < 5 || numberOfCards > 7 ) {
+    throw std::logic_error( "Five to seven cards are needed for evaluation." );
+  }
+
+  unsigned int cardIndices[ 7 ];
+  hand.indices( cardIndices );
+  return evaluate( cardIndices, numberOfCards );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// flop, turn or river: 3 to 5 common cards
+unsigned int FiveOfSevenCardEvaluator::evaluateHoldemHand( CardSet holeCards, CardSet commonCards ) const
+{
+  if( holeCards.size() != 2 || commonCards.size() < 3 || commonCards.size() > 5 || holeCards.intersects( commonCards ) ) {
+    throw std::logic_error( "Hold'em needs 2 hole cards and 3 to 5 other common cards." );
+  }
+
+  return evaluate( holeCards | commonCards );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+PreparedBoard FiveOfSevenCardEvaluator::prepareBoard( CardSet commonCards ) const
+{
+  unsigned int numberOfCommonCards = commonCards.size();
+  if( numberOfCommonCards < 3 || numberOfCommonCards > 5 ) {
+    throw std::logic_error( "Hold'em needs 3 to 5 common cards." );
+  }
+
+  PreparedBoard board;
+  board.cards_ = commonCards;
+  board.numberOfCards_ = numberOfCommonCards + 2;
+  board.ranks_ = rankTable( board.numberOfCards_ );
+  std::fill( board.rankCounts_, board.rankCounts_ + NUMBER_OF_RANKS, 0 );
+
+  unsigned int suitMasks[ 4 ] = { 0, 0, 0, 0 };
+  unsigned int suitCounts[ 4 ] = { 0, 0, 0, 0 };
+  unsigned int cardIndices[ 5 ];
+  commonCards.indices( cardIndices );
+  for( unsigned int i = 0; i < numberOfCommonCards; ++i ) {
+    unsigned int rank = cardIndices[ i ] >> 2;
+    unsigned int suit = cardIndices[ i ] & 0x03;
+    ++board.rankCounts_[ rank ];
+    suitMasks[ suit ] |= 1 << rank;
+    ++suitCounts[ suit ];
+  }
+
+  board.flushSuit_ = 4;
+  board.flushSuitMask_ = 0;
+  board.flushSuitCount_ = 0;
+  for( unsigned int suit = 0; suit < 4; ++suit ) {
+    if( suitCounts[ suit ] >= 3 ) {
+      board.flushSuit_ = suit;
+      board.flushSuitMask_ = suitMasks[ suit ];
+      board.flushSuitCount_ = suitCounts[ suit ];
+    }
+  }
+
+  // term of rank r in the n card hash, when h hole cards rank below r:
+  // quinaryOffsets[ r ][ n - h - board cards below r ][ board count of r ]
+  unsigned int cardsBelow = 0;
+  for( unsigned int h = 0; h < 3; ++h ) {
+    board.hashPrefixes_[ h ][ 0 ] = 0;
+  }
+  for( unsigned int rank = 0; rank < NUMBER_OF_RANKS; ++rank ) {
+    board.cardsBelow_[ rank ] = cardsBelow;
+    for( unsigned int h = 0; h < 3; ++h ) {
+      board.hashPrefixes_[ h ][ rank + 1 ] = board.hashPrefixes_[ h ][ rank ]
+        + quinaryOffsets[ rank ][ board.numberOfCards_ - h - cardsBelow ][ board.rankCounts_[ rank ] ];
+    }
+    cardsBelow += board.rankCounts_[ rank ];
+  }
+
+  return board;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int FiveOfSevenCardEvaluator::evaluateHoldemHand( const PreparedBoard& board,
+                                                           unsigned int holeCard1, unsigned int holeCard2 ) const
+{
+  if( board.flushSuit_ < 4 ) {
+    unsigned int mask = board.flushSuitMask_;
+    unsigned int count = board.flushSuitCount_;
+    if( ( holeCard1 & 0x03 ) == board.flushSuit_ ) {
+      mask |= 1 << ( holeCard1 >> 2 );
+      ++count;
+    }
+    if( ( holeCard2 & 0x03 ) == board.flushSuit_ ) {
+      mask |= 1 << ( holeCard2 >> 2 );
+      ++count;
+    }
+    if( count >= 5 ) {
+      return flushes[ mask ];
+    }
+  }
+
+  unsigned int low = holeCard1 >> 2;
+  unsigned int high = holeCard2 >> 2;
+  if( low > high ) {
+    std::swap( low, high );
+  }
+
+  unsigned int hash = board.hashPrefixes_[ 0 ][ low ];
+  if( low == high ) {
+    hash += quinaryOffsets[ low ][ board.numberOfCards_ - board.cardsBelow_[ low ] ][ board.rankCounts_[ low ] + 2 ];
+  }
+  else {
+    hash += quinaryOffsets[ low ][ board.numberOfCards_ - board.cardsBelow_[ low ] ][ board.rankCounts_[ low ] + 1 ]
+      + board.hashPrefixes_[ 1 ][ high ] - board.hashPrefixes_[ 1 ][ low + 1 ]
+      + quinaryOffsets[ high ][ board.numberOfCards_ - 1 - board.cardsBelow_[ high ] ][ board.rankCounts_[ high ] + 1 ];
+  }
+  hash += board.hashPrefixes_[ 2 ][ NUMBER_OF_RANKS ] - board.hashPrefixes_[ 2 ][ high + 1 ];
+
+  return board.ranks_[ hash ];
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int FiveOfSevenCardEvaluator::evaluateHoldemHand( const PreparedBoard& board, CardSet holeCards ) const
+{
+  std::uint64_t mask = holeCards.mask();
+  unsigned int holeCard1 = __builtin_ctzll( mask );
+  mask &= mask - 1;
+  return evaluateHoldemHand( board, holeCard1, __builtin_ctzll( mask ) );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+BestHand FiveOfSevenCardEvaluator::evaluateBestHand( CardSet hand ) const
+{
+  unsigned int handValue = evaluate( hand );
+  return BestHand{ handValue, FiveCardEvaluator::bestFiveCards( handValue, hand ) };
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+BestHand FiveOfSevenCardEvaluator::evaluateBestHoldemHand( const PreparedBoard& board, CardSet holeCards ) const
+{
+  unsigned int handValue = evaluateHoldemHand( board, holeCards );
+  return BestHand{ handValue, FiveCardEvaluator::bestFiveCards( handValue, board.cards() | holeCards ) };
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+ShowdownResult FiveOfSevenCardEvaluator::showdown( const PreparedBoard& board, const CardSet holeCards[],
+                                                   unsigned int numberOfSeats ) const
+{
+  if( numberOfSeats == 0 || numberOfSeats > MAX_SEATS ) {
+    throw std::logic_error( "A showdown needs 1 to 10 seats." );
+  }
+  CardSet usedCards = board.cards();
+  for( unsigned int seat = 0; seat < numberOfSeats; ++seat ) {
+    if( holeCards[ seat ].size() != 2 ) {
+      throw std::logic_error( "Hold'em needs 2 hole cards." );
+    }
+    if( usedCards.mask() & holeCards[ seat ].mask() ) {
+      throw std::logic_error( "The same card is given twice." );
+    }
+    usedCards |= holeCards[ seat ];
+  }
+
+  ShowdownResult result;
+  for( unsigned int seat = 0; seat < numberOfSeats; ++seat ) {
+    result.values[ seat ] = evaluateHoldemHand( board, holeCards[ seat ] );
+  }
+
+  result.settle( numberOfSeats );
+
+  return result;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+void FiveOfSevenCardEvaluator::evaluateHoldemHandsScalar( const PreparedBoard& board, const unsigned int pairValues[],
+                                                          const unsigned int holeCards1[], const unsigned int holeCards2[],
+                                                          std::size_t numberOfHands, unsigned short values[] )
+{
+  for( std::size_t i = 0; i < numberOfHands; ++i ) {
+    unsigned int holeCard1 = holeCards1[ i ];
+    unsigned int holeCard2 = holeCards2[ i ];
+    unsigned int mask = board.flushSuitMask_;
+    unsigned int count = board.flushSuitCount_;
+    if( ( holeCard1 & 0x03 ) == board.flushSuit_ ) {
+      mask |= 1 << ( holeCard1 >> 2 );
+      ++count;
+    }
+    if( ( holeCard2 & 0x03 ) == board.flushSuit_ ) {
+      mask |= 1 << ( holeCard2 >> 2 );
+      ++count;
+    }
+    values[ i ] = count >= 5 ? flushes[ mask ] : pairValues[ ( holeCard1 >> 2 ) * NUMBER_OF_RANKS + ( holeCard2 >> 2 ) ];
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+__attribute__(( target( "avx2" ) ))
+void FiveOfSevenCardEvaluator::evaluateHoldemHandsAvx2( const PreparedBoard& board, const unsigned int pairValues[],
+                                                        const unsigned int holeCards1[], const unsigned int holeCards2[],
+                                                        std::size_t numberOfHands, unsigned short values[] )
+{
+  const __m256i three = _mm256_set1_epi32( 3 );
+  const __m256i one = _mm256_set1_epi32( 1 );
+  const __m256i flushSuit = _mm256_set1_epi32( board.flushSuit_ );
+  const __m256i boardMask = _mm256_set1_epi32( board.flushSuitMask_ );
+  const __m256i boardCount = _mm256_set1_epi32( board.flushSuitCount_ );
+  const __m256i ranks = _mm256_set1_epi32( NUMBER_OF_RANKS );
+  const __m256i four = _mm256_set1_epi32( 4 );
+  const __m256i low16 = _mm256_set1_epi32( 0xffff );
+
+  std::size_t end = numberOfHands & ~(std::size_t) 7;
+  for( std::size_t i = 0; i < end; i += 8 ) {
+    __m256i c1 = _mm256_loadu_si256( (const __m256i*) ( holeCards1 + i ) );
+    __m256i c2 = _mm256_loadu_si256( (const __m256i*) ( holeCards2 + i ) );
+    __m256i r1 = _mm256_srli_epi32( c1, 2 );
+    __m256i r2 = _mm256_srli_epi32( c2, 2 );
+    __m256i value = _mm256_i32gather_epi32( (const int*) pairValues, _mm256_add_epi32( _mm256_mullo_epi32( r1, ranks ), r2 ), 4 );
+
+    __m256i suited1 = _mm256_cmpeq_epi32( _mm256_and_si256( c1, three ), flushSuit );
+    __m256i suited2 = _mm256_cmpeq_epi32( _mm256_and_si256( c2, three ), flushSuit );
+    __m256i mask = _mm256_or_si256( boardMask, _mm256_and_si256( suited1, _mm256_sllv_epi32( one, r1 ) ) );
+    mask = _mm256_or_si256( mask, _mm256_and_si256( suited2, _mm256_sllv_epi32( one, r2 ) ) );
+    __m256i count = _mm256_sub_epi32( _mm256_sub_epi32( boardCount, suited1 ), suited2 );
+
+    // a flush needs five cards; only those lanes read the 16 bit flush table
+    __m256i isFlush = _mm256_cmpgt_epi32( count, four );
+    __m256i flushValue = _mm256_mask_i32gather_epi32( _mm256_setzero_si256(), (const int*) flushes, mask, isFlush, 2 );
+    value = _mm256_blendv_epi8( value, _mm256_and_si256( flushValue, low16 ), isFlush );
+
+    __m256i packed = _mm256_permute4x64_epi64( _mm256_packus_epi32( value, value ), 0x08 );
+    _mm_storeu_si128( (__m128i*) ( values + i ), _mm256_castsi256_si128( packed ) );
+  }
+
+  evaluateHoldemHandsScalar( board, pairValues, holeCards1 + end, holeCards2 + end, numberOfHands - end, values + end );
+}
+#endif
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+void FiveOfSevenCardEvaluator::evaluateHoldemHands( const PreparedBoard& board,
+                                                    const unsigned int holeCards1[], const unsigned int holeCards2[],
+                                                    std::size_t numberOfHands, unsigned short values[] ) const
+{
+  static const HoldemHandsKernel kernel = dispatchKernel< HoldemHandsKernel >( &evaluateHoldemHandsScalar, nullptr,
+                                                                              X86_KERNEL( &evaluateHoldemHandsAvx2 ), nullptr );
+
+  // non flush values of every possible rank pair, in both orders
+  unsigned int pairValues[ NUMBER_OF_RANKS * NUMBER_OF_RANKS ];
+  for( unsigned int low = 0; low < NUMBER_OF_RANKS; ++low ) {
+    for( unsigned int high = low; high < NUMBER_OF_RANKS; ++high ) {
+      unsigned int value = 0;
+      if( board.rankCounts_[ low ] + ( low == high ? 2 : 1 ) <= 4 && board.rankCounts_[ high ] < 4 ) {
+        unsigned int hash = board.hashPrefixes_[ 0 ][ low ] + board.hashPrefixes_[ 2 ][ NUMBER_OF_RANKS ] - board.hashPrefixes_[ 2 ][ high + 1 ];
+        if( low == high ) {
+          hash += quinaryOffsets[ low ][ board.numberOfCards_ - board.cardsBelow_[ low ] ][ board.rankCounts_[ low ] + 2 ];
+        }
+        else {
+          hash += quinaryOffsets[ low ][ board.numberOfCards_ - board.cardsBelow_[ low ] ][ board.rankCounts_[ low ] + 1 ]
+            + board.hashPrefixes_[ 1 ][ high ] - board.hashPrefixes_[ 1 ][ low + 1 ]
+            + quinaryOffsets[ high ][ board.numberOfCards_ - 1 - board.cardsBelow_[ high ] ][ board.rankCounts_[ high ] + 1 ];
+        }
+        value = board.ranks_[ hash ];
+      }
+      pairValues[ low * NUMBER_OF_RANKS + high ] = value;
+      pairValues[ high * NUMBER_OF_RANKS + low ] = value;
+    }
+  }
+
+  kernel( board, pairValues, holeCards1, holeCards2, numberOfHands, values );
+}
@@ -0,0 +1,134 @@
+#ifndef POKER_FIVE_OF_SEVEN_CARD_EVALUATOR_H
+#define POKER_FIVE_OF_SEVEN_CARD_EVALUATOR_H
+
+#include <vector>
+#include <string>
+#include <mutex>
+#include <cstddef>
+#include "CardDeck.h"
+#include "FiveCardEvaluator.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#define NUMBER_OF_RANKS 13
+#define FLUSH_TABLE_SIZE 8192
+#define RANK_TABLE_SIZE_5 6175
+#define RANK_TABLE_SIZE_6 18395
+#define RANK_TABLE_SIZE_7 49205
+#define MAX_SEATS 10
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// The board side of a Hold'em showdown on the flop, turn or river, computed once
+// by FiveOfSevenCardEvaluator::prepareBoard. Besides the suit masks and suit
+// counts it keeps the prefix sums of the quinary hash terms for 0, 1 and 2 hole
+// cards ranked below each rank, so a hole card pair is hashed with a handful of
+// loads.
+class PreparedBoard {
+private:
+   friend class FiveOfSevenCardEvaluator;
+
+   CardSet cards_;
+   unsigned int numberOfCards_;   // common cards plus the two hole cards
+   const unsigned short* ranks_;
+   unsigned char rankCounts_[ NUMBER_OF_RANKS ];
+   unsigned char cardsBelow_[ NUMBER_OF_RANKS ];
+   unsigned short hashPrefixes_[ 3 ][ NUMBER_OF_RANKS + 1 ];
+   unsigned int flushSuit_;       // suit with three or more cards, 4 if there is none
+   unsigned int flushSuitMask_;
+   unsigned int flushSuitCount_;
+
+public:
+   inline CardSet cards() const { return cards_; }
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Outcome of one showdown. Every seat with the best hand is in winners and gets
+// an equal share of the pot, all other seats get nothing.
+struct ShowdownResult {
+   unsigned int winners;              // bit s for seat s
+   unsigned int numberOfWinners;
+   unsigned short values[ MAX_SEATS ];
+   float shares[ MAX_SEATS ];
+
+   // fills winners and shares from the values of the first numberOfSeats seats
+   void settle( unsigned int numberOfSeats, bool lowerIsBetter = true );
+};
+
+#define SHOWDOWN_BLOCK_SIZE 1024
+
+// The hero's side of SHOWDOWN_BLOCK_SIZE Monte Carlo showdowns at once, lower
+// values are better. opponentValues holds numberOfOpponents rows of
+// SHOWDOWN_BLOCK_SIZE values, trial i in column i. tiedWins[ t ] gets the number
+// of trials the hero won together with t opponents, so the hero's pot shares are
+// the sum of tiedWins[ t ] / ( t + 1 ). Unused trials can be padded with a hero
+// value of 0xffff and opponent values of 0, they are lost. The kernel, scalar,
+// SSE4.2, AVX2 or AVX-512, is picked once by dispatchKernel().
+void settleShowdownBlock( const unsigned short heroValues[], const unsigned short opponentValues[],
+                          unsigned int numberOfOpponents, unsigned int tiedWins[ MAX_SEATS ] );
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Evaluates the best five cards out of five, six or seven in a single pass.
+// Flushes are looked up by the rank mask of the flush suit, all other hands by a
+// perfect hash of the rank multiset into the table for that number of cards. The
+// values are on the same 1..7462 scale as FiveCardEvaluator.
+class FiveOfSevenCardEvaluator {
+private:
+   friend class EquityEnumerator;
+
+   static unsigned short flushes[ FLUSH_TABLE_SIZE ];
+   static unsigned short ranks5[ RANK_TABLE_SIZE_5 ];
+   static unsigned short ranks6[ RANK_TABLE_SIZE_6 ];
+   static unsigned short ranks7[ RANK_TABLE_SIZE_7 ];
+   static unsigned int quinaryOffsets[ NUMBER_OF_RANKS ][ 8 ][ 5 ];
+   static std::once_flag tablesInitialized_;
+
+   typedef void ( *HoldemHandsKernel )( const PreparedBoard& board, const unsigned int pairValues[],
+                                        const unsigned int holeCards1[], const unsigned int holeCards2[],
+                                        std::size_t numberOfHands, unsigned short values[] );
+
+   static void generateTables();
+   static unsigned int quinaryHash( const unsigned char rankCounts[], unsigned int numberOfCards );
+   static const unsigned short* rankTable( unsigned int numberOfCards );
+   static void evaluateHoldemHandsScalar( const PreparedBoard& board, const unsigned int pairValues[],
+                                          const unsigned int holeCards1[], const unsigned int holeCards2[],
+                                          std::size_t numberOfHands, unsigned short values[] );
+   static void evaluateHoldemHandsAvx2( const PreparedBoard& board, const unsigned int pairValues[],
+                                        const unsigned int holeCards1[], const unsigned int holeCards2[],
+                                        std::size_t numberOfHands, unsigned short values[] );
+
+public:
+   FiveOfSevenCardEvaluator();
+
+   unsigned int evaluate( const unsigned int cardIndices[], unsigned int numberOfCards ) const;   // 5 to 7 cards
+   unsigned int evaluate( const unsigned int cardIndices[ 7 ] ) const;
+   unsigned int evaluate( const Hand& hand ) const;
+   unsigned int evaluate( CardSet hand ) const;
+
+   // 2 hole cards and 3, 4 or 5 common cards
+   unsigned int evaluateHoldemHand( const Hand& holeCards, const Hand& commonCards ) const;
+   unsigned int evaluateHoldemHand( CardSet holeCards, CardSet commonCards ) const;
+
+   PreparedBoard prepareBoard( CardSet commonCards ) const;
+   unsigned int evaluateHoldemHand( const PreparedBoard& board, unsigned int holeCard1, unsigned int holeCard2 ) const;
+   unsigned int evaluateHoldemHand( const PreparedBoard& board, CardSet holeCards ) const;   // unchecked, 2 cards off the board
+
+   // The value plus the five cards used. The plain evaluation is done first, the
+   // cards are then picked by FiveCardEvaluator::bestFiveCards.
+   BestHand evaluateBestHand( CardSet hand ) const;
+   BestHand evaluateBestHoldemHand( const PreparedBoard& board, CardSet holeCards ) const;
+
+   // Showdown of 1 to MAX_SEATS hole card pairs on a prepared board. Every seat
+   // needs 2 cards, none of them on the board or in another seat.
+   ShowdownResult showdown( const PreparedBoard& board, const CardSet holeCards[], unsigned int numberOfSeats ) const;
+
+   // Scores many hole card pairs, given as card indices, against one board. The
+   // non flush value of every rank pair is computed once, after that each hand is
+   // a table gather plus a flush check, run 8 hands at a time on AVX2.
+   void evaluateHoldemHands( const PreparedBoard& board, const unsigned int holeCards1[], const unsigned int holeCards2[],
+                             std::size_t numberOfHands, unsigned short values[] ) const;
+};
+
+#endif
@@ -0,0 +1,89 @@
+#include <stdexcept>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "LookupTableEvaluator.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+LookupTableEvaluator::LookupTableEvaluator( const std::string& fileName )
+  : table_( nullptr ),
+    mapping_( MAP_FAILED ),
+    mappingSize_( 0 )
+{
+  int fd = open( fileName.c_str(), O_RDONLY );
+  if( fd < 0 ) {
+    throw std::runtime_error( "Can not open lookup table " + fileName + "." );
+  }
+
+  struct stat fileStatus;
+  if( fstat( fd, &fileStatus ) != 0 || (std::size_t) fileStatus.st_size < sizeof( LookupTableHeader ) ) {
+    close( fd );
+    throw std::runtime_error( "Lookup table " + fileName + " is truncated." );
+  }
+
+  mappingSize_ = fileStatus.st_size;
+  mapping_ = mmap( nullptr, mappingSize_, PROT_READ, MAP_SHARED, fd, 0 );
+  close( fd );
+  if( mapping_ == MAP_FAILED ) {
+    throw std::runtime_error( "Can not map lookup table " + fileName + "." );
+  }
+
+  const LookupTableHeader* header = (const LookupTableHeader*) mapping_;
+  std::size_t expectedSize = sizeof( LookupTableHeader )
+    + (std::size_t) header->numberOfRows * LOOKUP_TABLE_ROW_SIZE * sizeof( std::uint32_t );
+  if( std::memcmp( header->magic, LOOKUP_TABLE_MAGIC, sizeof( header->magic ) ) != 0 || expectedSize != mappingSize_ ) {
+    munmap( mapping_, mappingSize_ );
+    throw std::runtime_error( "File " + fileName + " is no valid lookup table." );
+  }
+
+  table_ = (const std::uint32_t*) ( header + 1 );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+LookupTableEvaluator::~LookupTableEvaluator()
+{
+  munmap( mapping_, mappingSize_ );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int LookupTableEvaluator::evaluate( const Hand& hand ) const
+{
+  unsigned int numberOfCards = hand.cards().size();
+  if( numberOfCards < 5 || numberOfCards > 7 ) {
+    throw std::logic_error( "Five to seven cards are needed for evaluation." );
+  }
+
+  unsigned int cardIndices[ 7 ];
+  for( unsigned int i = 0; i < numberOfCards; ++i ) {
+    cardIndices[ i ] = hand.cards()[ i ].index();
+  }
+
+  return evaluate( cardIndices, numberOfCards );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int LookupTableEvaluator::evaluateHoldemHand( const Hand& holeCards, const Hand& commonCards ) const
+{
+  unsigned int numberOfCards = holeCards.cards().size() + commonCards.cards().size();
+  if( numberOfCards < 5 || numberOfCards > 7 ) {
+    throw std::logic_error( "Five to seven cards are needed for evaluation." );
+  }
+
+  unsigned int cardIndices[ 7 ];
+  unsigned int i = 0;
+  for( const Card& card : holeCards.cards() ) {
+    cardIndices[ i++ ] = card.index();
+  }
+  for( const Card& card : commonCards.cards() ) {
+    cardIndices[ i++ ] = card.index();
+  }
+
+  return evaluate( cardIndices, numberOfCards );
+}
@@ -0,0 +1,57 @@
+#ifndef POKER_LOOKUP_TABLE_EVALUATOR_H
+#define POKER_LOOKUP_TABLE_EVALUATOR_H
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include "CardDeck.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#define LOOKUP_TABLE_MAGIC "PKRLUT01"
+#define LOOKUP_TABLE_ROW_SIZE 53
+#define LOOKUP_TABLE_ROOT LOOKUP_TABLE_ROW_SIZE
+
+struct LookupTableHeader {
+   char magic[ 8 ];
+   std::uint32_t numberOfRows;
+   std::uint32_t reserved;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// State machine evaluator. Every row of the table is a state, i.e. the cards seen
+// so far, and holds the hand value of that state in column 0 and the offset of the
+// next row for every Card::index() in columns 1..52. After the sixth card the
+// columns hold the final seven card values instead. Row 0 is the dead state for
+// impossible hands and evaluates to 0.
+//
+// The table file is built by lookupTableGenerator and mapped read only, so the
+// pages are shared between all processes using the same file.
+class LookupTableEvaluator {
+private:
+   const std::uint32_t* table_;
+   void* mapping_;
+   std::size_t mappingSize_;
+
+   LookupTableEvaluator( const LookupTableEvaluator& );
+   LookupTableEvaluator& operator=( const LookupTableEvaluator& );
+
+public:
+   LookupTableEvaluator( const std::string& fileName );
+   ~LookupTableEvaluator();
+
+   inline unsigned int evaluate( const unsigned int cardIndices[], unsigned int numberOfCards ) const
+   {
+      std::uint32_t p = LOOKUP_TABLE_ROOT;
+      for( unsigned int i = 0; i < numberOfCards; ++i ) {
+         p = table_[ p + cardIndices[ i ] + 1 ];
+      }
+      return numberOfCards == 7 ? p : table_[ p ];
+   }
+
+   unsigned int evaluate( const Hand& hand ) const;
+   unsigned int evaluateHoldemHand( const Hand& holeCards, const Hand& commonCards ) const;
+};
+
+#endif
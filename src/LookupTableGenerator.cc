@@ -0,0 +1,272 @@
+// Builds the state machine table used by LookupTableEvaluator.
+//
+// A state is the multiset of ranks seen so far plus the rank mask of every suit
+// that can still make a flush with the cards to come (a suit is dead as soon as
+// it holds fewer than n - 2 of n cards). Hands differing only in dead suits share
+// their row, which keeps the table at a few hundred thousand rows.
+//
+// All hand values are taken from FiveCardEvaluator::evaluate on the best five
+// card subset.
+//
+// usage: lookupTableGenerator [ file name ]
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <unordered_map>
+
+#include "FiveCardEvaluator.h"
+#include "LookupTableEvaluator.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+   const std::uint64_t DEAD_SUIT = 0x1fff;
+
+   struct State {
+      std::uint64_t rankCounts;   // 3 bits per rank
+      std::uint64_t suitMasks;    // 13 bits per suit, DEAD_SUIT once it can not flush
+      unsigned int numberOfCards;
+
+      bool operator==( const State& other ) const
+      {
+         return rankCounts == other.rankCounts && suitMasks == other.suitMasks;
+      }
+
+      unsigned int rankCount( unsigned int rank ) const { return ( rankCounts >> ( 3 * rank ) ) & 0x07; }
+      std::uint64_t suitMask( unsigned int suit ) const { return ( suitMasks >> ( 13 * suit ) ) & 0x1fff; }
+   };
+
+   struct StateHash {
+      std::size_t operator()( const State& state ) const
+      {
+         return ( state.rankCounts * 0x9e3779b97f4a7c15ULL ) ^ ( state.suitMasks + ( state.suitMasks >> 29 ) );
+      }
+   };
+
+   //////////////////////////////////////////////////////////////////////////////////////////
+
+   class TableGenerator {
+   private:
+      FiveCardEvaluator evaluator_;
+      std::vector< unsigned short > flushValues_;
+      std::unordered_map< std::uint64_t, unsigned short > rankValues_;
+      std::unordered_map< State, std::uint32_t, StateHash > rows_;
+      std::vector< std::uint32_t > table_;
+
+      unsigned int bestFiveCardValue( const Hand::Cards& cards );
+      unsigned int flushValue( std::uint64_t mask );
+      unsigned int rankValue( const State& state );
+      unsigned int value( const State& state );
+      bool addCard( const State& state, unsigned int cardIndex, State& next ) const;
+      std::uint32_t addRow( const State& state, std::vector< State >& level );
+
+   public:
+      TableGenerator();
+      void generate();
+      void write( const std::string& fileName ) const;
+   };
+
+   //////////////////////////////////////////////////////////////////////////////////////////
+
+   TableGenerator::TableGenerator()
+     : flushValues_( 8192, 0 )
+   {
+   }
+
+   //////////////////////////////////////////////////////////////////////////////////////////
+
+   unsigned int TableGenerator::bestFiveCardValue( const Hand::Cards& cards )
+   {
+      unsigned int bestValue = 9999;
+      unsigned int n = cards.size();
+      for( unsigned int a = 0; a < n; ++a )
+         for( unsigned int b = a + 1; b < n; ++b )
+            for( unsigned int c = b + 1; c < n; ++c )
+               for( unsigned int d = c + 1; d < n; ++d )
+                  for( unsigned int e = d + 1; e < n; ++e ) {
+                     Hand h = { cards[ a ], cards[ b ], cards[ c ], cards[ d ], cards[ e ] };
+                     unsigned int handValue = evaluator_.evaluate( h );
+                     if( handValue < bestValue ) {
+                        bestValue = handValue;
+                     }
+                  }
+
+      return bestValue;
+   }
+
+   //////////////////////////////////////////////////////////////////////////////////////////
+
+   unsigned int TableGenerator::flushValue( std::uint64_t mask )
+   {
+      if( flushValues_[ mask ] == 0 ) {
+         Hand::Cards cards;
+         for( unsigned int rank = 0; rank < 13; ++rank ) {
+            if( mask & ( 1 << rank ) ) {
+               cards.push_back( Card( (CardRank) rank, SPADE ) );
+            }
+         }
+         flushValues_[ mask ] = bestFiveCardValue( cards );
+      }
+
+      return flushValues_[ mask ];
+   }
+
+   //////////////////////////////////////////////////////////////////////////////////////////
+
+   unsigned int TableGenerator::rankValue( const State& state )
+   {
+      auto it = rankValues_.find( state.rankCounts );
+      if( it != rankValues_.end() ) {
+         return it->second;
+      }
+
+      // suits are dealt round robin, so no suit gets more than two of seven cards
+      Hand::Cards cards;
+      unsigned int cardCounter = 0;
+      for( unsigned int rank = 0; rank < 13; ++rank ) {
+         for( unsigned int i = 0; i < state.rankCount( rank ); ++i ) {
+            cards.push_back( Card( (CardRank) rank, (CardSuit) ( cardCounter++ % 4 ) ) );
+         }
+      }
+
+      unsigned short handValue = bestFiveCardValue( cards );
+      rankValues_[ state.rankCounts ] = handValue;
+      return handValue;
+   }
+
+   //////////////////////////////////////////////////////////////////////////////////////////
+
+   unsigned int TableGenerator::value( const State& state )
+   {
+      unsigned int handValue = rankValue( state );
+      for( unsigned int suit = 0; suit < 4; ++suit ) {
+         std::uint64_t mask = state.suitMask( suit );
+         if( mask != DEAD_SUIT && __builtin_popcountll( mask ) >= 5 && flushValue( mask ) < handValue ) {
+            handValue = flushValue( mask );
+         }
+      }
+
+      return handValue;
+   }
+
+   //////////////////////////////////////////////////////////////////////////////////////////
+
+   bool TableGenerator::addCard( const State& state, unsigned int cardIndex, State& next ) const
+   {
+      unsigned int rank = cardIndex >> 2;
+      unsigned int suit = cardIndex & 0x03;
+      if( state.rankCount( rank ) == 4 ) {
+         return false;
+      }
+
+      next = state;
+      next.rankCounts += 1ULL << ( 3 * rank );
+      next.numberOfCards = state.numberOfCards + 1;
+
+      std::uint64_t mask = state.suitMask( suit );
+      if( mask != DEAD_SUIT ) {
+         if( mask & ( 1 << rank ) ) {
+            return false;
+         }
+         next.suitMasks |= 1ULL << ( 13 * suit + rank );
+      }
+
+      for( unsigned int s = 0; s < 4; ++s ) {
+         mask = next.suitMask( s );
+         if( mask != DEAD_SUIT && (int) __builtin_popcountll( mask ) + 7 - (int) next.numberOfCards < 5 ) {
+            next.suitMasks |= DEAD_SUIT << ( 13 * s );
+         }
+      }
+
+      return true;
+   }
+
+   //////////////////////////////////////////////////////////////////////////////////////////
+
+   std::uint32_t TableGenerator::addRow( const State& state, std::vector< State >& level )
+   {
+      auto it = rows_.find( state );
+      if( it != rows_.end() ) {
+         return it->second;
+      }
+
+      std::uint32_t offset = table_.size();
+      table_.resize( table_.size() + LOOKUP_TABLE_ROW_SIZE, 0 );
+      rows_[ state ] = offset;
+      level.push_back( state );
+      return offset;
+   }
+
+   //////////////////////////////////////////////////////////////////////////////////////////
+
+   void TableGenerator::generate()
+   {
+      table_.assign( LOOKUP_TABLE_ROW_SIZE, 0 );
+
+      std::vector< State > level;
+      State root = { 0, 0, 0 };
+      addRow( root, level );
+
+      for( unsigned int numberOfCards = 0; numberOfCards < 7; ++numberOfCards ) {
+         std::vector< State > nextLevel;
+         for( const State& state : level ) {
+            std::uint32_t offset = rows_[ state ];
+            if( numberOfCards >= 5 ) {
+               table_[ offset ] = value( state );
+            }
+
+            for( unsigned int cardIndex = 0; cardIndex < CARDS_IN_DECK; ++cardIndex ) {
+               State next;
+               std::uint32_t entry = 0;
+               if( addCard( state, cardIndex, next ) ) {
+                  entry = numberOfCards == 6 ? value( next ) : addRow( next, nextLevel );
+               }
+               table_[ offset + cardIndex + 1 ] = entry;
+            }
+         }
+
+         std::cout << "states with " << numberOfCards << " cards: " << level.size() << std::endl;
+         level.swap( nextLevel );
+      }
+   }
+
+   //////////////////////////////////////////////////////////////////////////////////////////
+
+   void TableGenerator::write( const std::string& fileName ) const
+   {
+      LookupTableHeader header;
+      std::memcpy( header.magic, LOOKUP_TABLE_MAGIC, sizeof( header.magic ) );
+      header.numberOfRows = table_.size() / LOOKUP_TABLE_ROW_SIZE;
+      header.reserved = 0;
+
+      std::ofstream out( fileName.c_str(), std::ios::binary );
+      out.write( (const char*) &header, sizeof( header ) );
+      out.write( (const char*) table_.data(), table_.size() * sizeof( std::uint32_t ) );
+      if( !out ) {
+         throw std::runtime_error( "Can not write lookup table " + fileName + "." );
+      }
+
+      std::cout << "wrote " << header.numberOfRows << " rows to " << fileName << std::endl;
+   }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+int main( int argc, char * argv[] )
+{
+  try {
+    std::string fileName = argc > 1 ? argv[ 1 ] : "handRanks.lut";
+    TableGenerator generator;
+    generator.generate();
+    generator.write( fileName );
+  }
+  catch( std::exception& ex ) {
+    std::cout << "Catched exception: " << ex.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
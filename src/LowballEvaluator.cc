@@ -0,0 +1,153 @@
+#include <stdexcept>
+
+#include "LowballEvaluator.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+   // keeps the n lowest ranks
+   inline unsigned int lowestRanks( unsigned int rankBits, int n )
+   {
+      while( __builtin_popcount( rankBits ) > n ) {
+         rankBits &= ~( 1u << ( 31 - __builtin_clz( rankBits ) ) );
+      }
+      return rankBits;
+   }
+
+   // With fewer than five different ranks every rank is used and the missing
+   // cards are spread over the ranks in every possible way. ranks and counts are
+   // by ace low rank, so the prime of the ace is the one of the deuce.
+   void bestPairedAceToFive( const unsigned char rankCounts[], const unsigned int ranks[], unsigned int numberOfRanks,
+                             unsigned int i, unsigned int cardsLeft, unsigned int primeProduct, unsigned int& bestValue )
+   {
+      if( i == numberOfRanks ) {
+         if( cardsLeft == 0 ) {
+            unsigned int value = lowballTables.pairedAceToFive[
+               fiveCardEvaluatorTables.hashValues[ FiveCardEvaluatorTables::findFast( primeProduct ) ] ];
+            bestValue = std::min( bestValue, value );
+         }
+         return;
+      }
+
+      unsigned int ranksLeft = numberOfRanks - i - 1;
+      unsigned int prime = FiveCardEvaluatorTables::prime( ranks[ i ] );
+      for( unsigned int count = 1; count <= rankCounts[ ranks[ i ] ] && count + ranksLeft <= cardsLeft; ++count ) {
+         primeProduct *= prime;
+         bestPairedAceToFive( rankCounts, ranks, numberOfRanks, i + 1, cardsLeft - count, primeProduct, bestValue );
+      }
+   }
+
+   template< class Combinations >
+   unsigned int bestDeuceToSeven( const LowballEvaluator& evaluator, const unsigned int rawCards[] )
+   {
+      constexpr auto& rows = Combinations::rows.cards;
+      unsigned int bestValue = 9999;
+      for( unsigned int row = 0; row < Combinations::size; ++row ) {
+         bestValue = std::min( bestValue, evaluator.evaluateDeuceToSeven( rawCards[ rows[ row ][ 0 ] ], rawCards[ rows[ row ][ 1 ] ],
+                                                                         rawCards[ rows[ row ][ 2 ] ], rawCards[ rows[ row ][ 3 ] ],
+                                                                         rawCards[ rows[ row ][ 4 ] ] ) );
+      }
+      return bestValue;
+   }
+
+   void checkNumberOfCards( unsigned int numberOfCards )
+   {
+      if( numberOfCards < 5 || numberOfCards > 7 ) {
+         throw std::logic_error( "Five to seven cards are needed for evaluation." );
+      }
+   }
+
+   unsigned int rawCards( const Hand& hand, unsigned int raw[ 7 ] )
+   {
+      unsigned int numberOfCards = hand.cards().size();
+      checkNumberOfCards( numberOfCards );
+      for( unsigned int i = 0; i < numberOfCards; ++i ) {
+         raw[ i ] = hand.cards()[ i ].raw();
+      }
+      return numberOfCards;
+   }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// 2-7 has straights and flushes, so the five card subsets are scored one by one.
+unsigned int LowballEvaluator::evaluateDeuceToSeven( const unsigned int rawCards[], unsigned int numberOfCards ) const
+{
+  switch( numberOfCards ) {
+  case 5:
+    return evaluateDeuceToSeven( rawCards[ 0 ], rawCards[ 1 ], rawCards[ 2 ], rawCards[ 3 ], rawCards[ 4 ] );
+  case 6:
+    return bestDeuceToSeven< CardCombinations< 0, 6, ANY_NUMBER_OF_HOLE_CARDS > >( *this, rawCards );
+  default:
+    return bestDeuceToSeven< CardCombinations< 0, 7, ANY_NUMBER_OF_HOLE_CARDS > >( *this, rawCards );
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// A-5 ignores suits: with five or more different ranks the five lowest make the
+// hand, otherwise the duplicates are placed as cheaply as possible.
+unsigned int LowballEvaluator::evaluateAceToFive( const unsigned int rawCards[], unsigned int numberOfCards )
+{
+  unsigned char rankCounts[ 13 ] = { 0 };
+  unsigned int rankBits = 0;
+  for( unsigned int i = 0; i < numberOfCards; ++i ) {
+    unsigned int rank = ( ( ( rawCards[ i ] >> 8 ) & 0x0f ) + 1 ) % 13;
+    ++rankCounts[ rank ];
+    rankBits |= 1 << rank;
+  }
+
+  if( __builtin_popcount( rankBits ) >= 5 ) {
+    return lowballTables.aceToFive[ lowestRanks( rankBits, 5 ) ];
+  }
+
+  unsigned int ranks[ 4 ];
+  unsigned int numberOfRanks = 0;
+  for( unsigned int m = rankBits; m; m &= m - 1 ) {
+    ranks[ numberOfRanks++ ] = __builtin_ctz( m );
+  }
+
+  unsigned int bestValue = 9999;
+  bestPairedAceToFive( rankCounts, ranks, numberOfRanks, 0, 5, 1, bestValue );
+  return bestValue;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int LowballEvaluator::evaluateEightOrBetter( const unsigned int rawCards[], unsigned int numberOfCards )
+{
+  unsigned int rankBits = 0;
+  for( unsigned int i = 0; i < numberOfCards; ++i ) {
+    rankBits |= rawCards[ i ] >> 16;
+  }
+
+  rankBits = aceLowRanks( rankBits ) & 0xff;
+  return __builtin_popcount( rankBits ) >= 5 ? lowballTables.aceToFive[ lowestRanks( rankBits, 5 ) ] : NO_LOW;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int LowballEvaluator::evaluateDeuceToSeven( const Hand& hand ) const
+{
+  unsigned int raw[ 7 ];
+  unsigned int numberOfCards = rawCards( hand, raw );
+  return evaluateDeuceToSeven( raw, numberOfCards );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int LowballEvaluator::evaluateAceToFive( const Hand& hand ) const
+{
+  unsigned int raw[ 7 ];
+  unsigned int numberOfCards = rawCards( hand, raw );
+  return evaluateAceToFive( raw, numberOfCards );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int LowballEvaluator::evaluateEightOrBetter( const Hand& hand ) const
+{
+  unsigned int raw[ 7 ];
+  unsigned int numberOfCards = rawCards( hand, raw );
+  return evaluateEightOrBetter( raw, numberOfCards );
+}
@@ -0,0 +1,115 @@
+#ifndef POKER_LOWBALL_EVALUATOR_H
+#define POKER_LOWBALL_EVALUATOR_H
+
+#include "CardDeck.h"
+#include "FiveCardEvaluator.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#define NUMBER_OF_ACE_TO_FIVE_VALUES 6175
+#define EIGHT_OR_BETTER_VALUES 56   // A-5 values 1..56 are the lows with no card above eight
+#define NO_LOW 0
+
+// Ace to five values, 1 for 5-4-3-2-A down to 6175 for four kings and a queen.
+// The 1287 hands without a pair come first, ordered by their ace low rank mask
+// read as a number, which compares the highest card first. The hands with a pair
+// or more follow in reverse Cactus Kev order, evaluated with the ace moved below
+// the deuce.
+//
+// Deuce to seven values are the Cactus Kev values turned upside down, except
+// that the ace is only high: 5-4-3-2-A is ace high, just better than
+// A-6-4-3-2 (785), and suited it is a flush just better than the A-6-4-3-2
+// flush (6648). The hands in between move up one value.
+struct LowballTables {
+   unsigned short aceToFive[ FIVE_CARD_TABLE_SIZE ];              // by ace low rank mask of five ranks
+   unsigned short pairedAceToFive[ NUMBER_OF_HAND_VALUES + 1 ];   // by Cactus Kev value on ace low ranks
+   unsigned short deuceToSeven[ NUMBER_OF_HAND_VALUES + 1 ];      // by Cactus Kev value
+
+   constexpr LowballTables()
+     : aceToFive(), pairedAceToFive(), deuceToSeven()
+   {
+      // Cactus Kev values: the wheel 1609, A-6-4-3-2 6678, the steel wheel 10 and the A-6-4-3-2 flush 815
+      const unsigned int wheel = NUMBER_OF_HAND_VALUES + 1 - 1609;
+      const unsigned int aceSixHigh = NUMBER_OF_HAND_VALUES + 1 - 6678;
+      const unsigned int steelWheel = NUMBER_OF_HAND_VALUES + 1 - 10;
+      const unsigned int aceSixFlush = NUMBER_OF_HAND_VALUES + 1 - 815;
+      for( unsigned int highValue = 1; highValue <= NUMBER_OF_HAND_VALUES; ++highValue ) {
+         unsigned int lowValue = NUMBER_OF_HAND_VALUES + 1 - highValue;
+         deuceToSeven[ highValue ] = lowValue == wheel ? aceSixHigh
+            : lowValue == steelWheel ? aceSixFlush
+            : lowValue + ( lowValue >= aceSixHigh ) - ( lowValue > wheel ) + ( lowValue >= aceSixFlush ) - ( lowValue > steelWheel );
+      }
+
+      unsigned int value = 1;
+      for( unsigned int rankBits = 0; rankBits < FIVE_CARD_TABLE_SIZE; ++rankBits ) {
+         if( __builtin_popcount( rankBits ) == 5 ) {
+            aceToFive[ rankBits ] = value++;
+         }
+      }
+      // straights and flushes never have a pair, so the paired hands are 11..322 and 1610..6185
+      for( unsigned int highValue = 6185; highValue >= 11; --highValue ) {
+         if( highValue <= 322 || highValue >= 1610 ) {
+            pairedAceToFive[ highValue ] = value++;
+         }
+      }
+   }
+};
+
+inline constexpr LowballTables lowballTables;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Lowball evaluators on Card::raw() values, lower is better on both scales:
+//   deuce to seven  straights and flushes count and the ace is high, so it is the
+//                   Cactus Kev value turned upside down, 1 for 7-5-4-3-2, with
+//                   5-4-3-2-A no straight, see LowballTables
+//   ace to five     straights and flushes do not count and the ace is low, see
+//                   LowballTables; eight or better is the same scale restricted
+//                   to the first EIGHT_OR_BETTER_VALUES values, NO_LOW otherwise
+class LowballEvaluator {
+private:
+   FiveCardEvaluator evaluator_;
+
+   // primes by rank with the ace below the deuce
+   static constexpr unsigned int aceLowPrimes[ 13 ] = { 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 2 };
+
+public:
+   // rank mask with the ace moved from bit 12 to bit 0
+   static inline unsigned int aceLowRanks( unsigned int rankBits )
+   {
+      return ( ( rankBits << 1 ) | ( rankBits >> 12 ) ) & 0x1fff;
+   }
+
+   inline unsigned int evaluateDeuceToSeven( unsigned int a, unsigned int b, unsigned int c, unsigned int d, unsigned int e ) const
+   {
+      return lowballTables.deuceToSeven[ evaluator_.evaluate( a, b, c, d, e ) ];
+   }
+
+   static inline unsigned int evaluateAceToFive( unsigned int a, unsigned int b, unsigned int c, unsigned int d, unsigned int e )
+   {
+      unsigned int rankBits = aceLowRanks( ( a | b | c | d | e ) >> 16 );
+      if( __builtin_popcount( rankBits ) == 5 ) {
+         return lowballTables.aceToFive[ rankBits ];
+      }
+      unsigned int primeProduct = aceLowPrimes[ ( a >> 8 ) & 0x0f ] * aceLowPrimes[ ( b >> 8 ) & 0x0f ] *
+         aceLowPrimes[ ( c >> 8 ) & 0x0f ] * aceLowPrimes[ ( d >> 8 ) & 0x0f ] * aceLowPrimes[ ( e >> 8 ) & 0x0f ];
+      return lowballTables.pairedAceToFive[ fiveCardEvaluatorTables.hashValues[ FiveCardEvaluatorTables::findFast( primeProduct ) ] ];
+   }
+
+   static inline unsigned int evaluateEightOrBetter( unsigned int a, unsigned int b, unsigned int c, unsigned int d, unsigned int e )
+   {
+      unsigned int rankBits = aceLowRanks( ( a | b | c | d | e ) >> 16 );
+      return __builtin_popcount( rankBits ) == 5 && rankBits < 0x100 ? lowballTables.aceToFive[ rankBits ] : NO_LOW;
+   }
+
+   // best low out of 5 to 7 cards
+   unsigned int evaluateDeuceToSeven( const unsigned int rawCards[], unsigned int numberOfCards ) const;
+   static unsigned int evaluateAceToFive( const unsigned int rawCards[], unsigned int numberOfCards );
+   static unsigned int evaluateEightOrBetter( const unsigned int rawCards[], unsigned int numberOfCards );
+
+   unsigned int evaluateDeuceToSeven( const Hand& hand ) const;
+   unsigned int evaluateAceToFive( const Hand& hand ) const;
+   unsigned int evaluateEightOrBetter( const Hand& hand ) const;
+};
+
+#endif
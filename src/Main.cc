@@ -7,38 +7,94 @@
 #include <future>
 #include <memory>
 #include <map>
+#include <thread>
+#include <functional>
+#include <algorithm>
 #include <unistd.h>
 
 #include "FiveCardEvaluator.h"
+#include "FiveOfSevenCardEvaluator.h"
+#include "SuitMaskEvaluator.h"
+#include "ShortDeckEvaluator.h"
+#include "CpuDispatch.h"
 
 #define MAX_MONTE_CARLO_SIMULATIONS  100000
+#define BENCHMARK_HANDS  65536
+#define BENCHMARK_ROUNDS  64
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
-float playHoldemWithFixedHoleCards( std::shared_ptr< FiveCardEvaluator > evaluator, 
+namespace {
+   // Plays MAX_MONTE_CARLO_SIMULATIONS trials in blocks of SHOWDOWN_BLOCK_SIZE.
+   // playTrial deals one trial and stores the hero's value and the opponents'
+   // values, SHOWDOWN_BLOCK_SIZE apart; the dispatched settleShowdownBlock()
+   // kernel then settles the whole block, split pots included.
+   template< class PlayTrial >
+   float heroEquity( int numberOfOpponents, PlayTrial playTrial )
+   {
+      unsigned short heroValues[ SHOWDOWN_BLOCK_SIZE ];
+      std::vector< unsigned short > opponentValues( numberOfOpponents * SHOWDOWN_BLOCK_SIZE );
+      double heroShares = 0.0;
+
+      for( int block = 0; block < MAX_MONTE_CARLO_SIMULATIONS; block += SHOWDOWN_BLOCK_SIZE ) {
+         for( int i = 0; i < SHOWDOWN_BLOCK_SIZE; ++i ) {
+            if( block + i >= MAX_MONTE_CARLO_SIMULATIONS ) {
+               // unused trials of the last block are lost
+               heroValues[ i ] = 0xffff;
+               for( int j = 0; j < numberOfOpponents; ++j ) {
+                  opponentValues[ j * SHOWDOWN_BLOCK_SIZE + i ] = 0;
+               }
+               continue;
+            }
+            playTrial( heroValues[ i ], opponentValues.data() + i );
+         }
+
+         unsigned int tiedWins[ MAX_SEATS ];
+         settleShowdownBlock( heroValues, opponentValues.data(), numberOfOpponents, tiedWins );
+         for( int t = 0; t <= numberOfOpponents; ++t ) {
+            heroShares += (double) tiedWins[ t ] / ( t + 1 );
+         }
+      }
+
+      return heroShares / MAX_MONTE_CARLO_SIMULATIONS;
+   }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Every trial deals a board and the opponents' hole cards. The hero's pot shares
+// add up to its equity, split pots included.
+float playHoldemWithFixedHoleCards( std::shared_ptr< FiveOfSevenCardEvaluator > evaluator, 
 				    std::shared_ptr< CardDeck > deck,
-				    std::shared_ptr< Hand > holeCards, 
+				    CardSet holeCards, 
 				    int numberOfOpponents )
 {
-   unsigned int looseCounter = 0;
-   
-   for( int i = 0; i < MAX_MONTE_CARLO_SIMULATIONS; ++i ) {
-      Hand commonCards = { deck->dealCard(), deck->dealCard(), deck->dealCard(), deck->dealCard(), deck->dealCard() };
-      unsigned int handValue = evaluator->evaluateHoldemHand( *holeCards, commonCards );
+   return heroEquity( numberOfOpponents, [ & ]( unsigned short& heroValue, unsigned short opponentValues[] ) {
+      PreparedBoard board = evaluator->prepareBoard( deck->dealCards( 5 ) );
+      heroValue = evaluator->evaluateHoldemHand( board, holeCards );
       for( int j = 0; j < numberOfOpponents; ++j ) {
-         Hand opponentHoleCards = { deck->dealCard(), deck->dealCard() };
-         unsigned int opponentHandValue = evaluator->evaluateHoldemHand( opponentHoleCards, commonCards );
-         if( handValue > opponentHandValue ) {
-            ++looseCounter;
-            break;
-         }
+         opponentValues[ j * SHOWDOWN_BLOCK_SIZE ] = evaluator->evaluateHoldemHand( board, deck->dealCards( 2 ) );
       }
-      
       deck->clean();
-   }
-   
-   
-   return 1.0 - (float) looseCounter / (float) MAX_MONTE_CARLO_SIMULATIONS;
+   } );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// The same simulation with a 36 card deck and short deck hand values.
+float playShortDeckHoldemWithFixedHoleCards( std::shared_ptr< ShortDeckEvaluator > evaluator,
+                                             std::shared_ptr< CardDeck > deck,
+                                             CardSet holeCards,
+                                             int numberOfOpponents )
+{
+   return heroEquity( numberOfOpponents, [ & ]( unsigned short& heroValue, unsigned short opponentValues[] ) {
+      CardSet commonCards = deck->dealCards( 5 );
+      heroValue = evaluator->evaluate( commonCards | holeCards );
+      for( int j = 0; j < numberOfOpponents; ++j ) {
+         opponentValues[ j * SHOWDOWN_BLOCK_SIZE ] = evaluator->evaluate( commonCards | deck->dealCards( 2 ) );
+      }
+      deck->clean();
+   } );
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -57,27 +113,45 @@ std::vector< T > solveAllFutures( std::vector< std::future< T > >& futures )
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
-void playHoldem( int numberOfOpponents )
+// Every hand simulated gets its own deck and random stream, numbered in the
+// order of the chart, so a master seed replays the whole chart exactly.
+void playHoldem( int numberOfOpponents, DeckType deckType, std::uint64_t masterSeed )
 {
-   std::shared_ptr< FiveCardEvaluator > evaluator( new FiveCardEvaluator() );
+   std::shared_ptr< FiveOfSevenCardEvaluator > evaluator;
+   std::shared_ptr< ShortDeckEvaluator > shortDeckEvaluator;
+   if( deckType == SHORT_DECK ) {
+      shortDeckEvaluator.reset( new ShortDeckEvaluator() );
+   }
+   else {
+      evaluator.reset( new FiveOfSevenCardEvaluator() );
+   }
+
+   auto simulate = [ & ]( std::shared_ptr< CardDeck > deck, CardSet holeCards ) {
+      if( deckType == SHORT_DECK ) {
+         return std::async( std::launch::async, playShortDeckHoldemWithFixedHoleCards, shortDeckEvaluator, deck, holeCards, numberOfOpponents );
+      }
+      return std::async( std::launch::async, playHoldemWithFixedHoleCards, evaluator, deck, holeCards, numberOfOpponents );
+   };
 
-   for( int i = 0; i < 13; ++i ) {
+   std::uint64_t streamId = 0;
+   int lowestRank = deckType == SHORT_DECK ? SIX : DEUCE;
+   for( int i = lowestRank; i < 13; ++i ) {
       std::vector< std::shared_ptr< Hand > > hands;
       std::vector< float > winningProbabilities;
       std::vector< std::future< float > > futureWinningProbabilities;
       for( int j = i; j < 13; ++j ) {
          if( i != j ) {
-            std::shared_ptr< CardDeck > deck( new CardDeck() );
+            std::shared_ptr< CardDeck > deck( new CardDeck( deckType, masterSeed, streamId++ ) );
             std::shared_ptr< Hand > h( new Hand( { deck->lockCard( i * 4 ), deck->lockCard( j * 4 ) } ) );
             hands.push_back( h );
-            futureWinningProbabilities.push_back( std::async( std::launch::async, playHoldemWithFixedHoleCards, evaluator, deck, h, numberOfOpponents ) );
+            futureWinningProbabilities.push_back( simulate( deck, CardSet( *h ) ) );
          }
          
          {
-            std::shared_ptr< CardDeck > deck( new CardDeck() );
+            std::shared_ptr< CardDeck > deck( new CardDeck( deckType, masterSeed, streamId++ ) );
             std::shared_ptr< Hand > h( new Hand( { deck->lockCard( i * 4 ), deck->lockCard( j * 4 + 1 ) } ) );
             hands.push_back( h );
-            futureWinningProbabilities.push_back( std::async( std::launch::async, playHoldemWithFixedHoleCards, evaluator, deck, h, numberOfOpponents ) );
+            futureWinningProbabilities.push_back( simulate( deck, CardSet( *h ) ) );
          }
       }
 
@@ -104,9 +178,9 @@ int testCardDeck()
       auto x1 = evaluator.evaluate( h1 );
       auto x2 = evaluator.evaluate( h2 );
       std::cout << h1.toString() ; 
-      std::cout << " :  " << evaluator.evaluateToString( h1 ) << std::endl;
+      std::cout << " :  " << FiveCardEvaluator::handRankName( x1 ) << std::endl;
       std::cout << h2.toString() ; 
-      std::cout << " :  " << evaluator.evaluateToString( h2 ) << std::endl;
+      std::cout << " :  " << FiveCardEvaluator::handRankName( x2 ) << std::endl;
       std::cout << ( x1 == x2 ? "Tie: both hands win" : x1 < x2 ? "First hand wins" : "Second hand wins" )  << std::endl << std::endl;
    } 
    
@@ -116,20 +190,120 @@ int testCardDeck()
 //////////////////////////////////////////////////////////////////////////////////////////
 
 namespace {
-   // std::map< std::string, std::string > getCommandLineOptions( int argc, char * argv[] ) 
-   // {
-   //    std::map< std::string, std::string > optionsMap;
-   //    return optionsMap;
-   // }
+   // options are given as --name=value, or --name for a flag
+   std::map< std::string, std::string > getCommandLineOptions( int argc, char * argv[] ) 
+   {
+      std::map< std::string, std::string > optionsMap;
+      for( int i = 1; i < argc; ++i ) {
+         std::string argument = argv[ i ];
+         if( argument.compare( 0, 2, "--" ) != 0 ) {
+            throw std::runtime_error( "Unknown argument " + argument + "." );
+         }
+         std::string::size_type equalSign = argument.find( '=' );
+         if( equalSign == std::string::npos ) {
+            optionsMap[ argument.substr( 2 ) ] = "";
+         }
+         else {
+            optionsMap[ argument.substr( 2, equalSign - 2 ) ] = argument.substr( equalSign + 1 );
+         }
+      }
+      return optionsMap;
+   }
+
+   TableLayout parseTableLayout( const std::string& name )
+   {
+      if( name == "split" ) {
+         return SPLIT_TABLES;
+      }
+      if( name == "compact" ) {
+         return COMPACT_TABLES;
+      }
+      throw std::runtime_error( "Unknown table layout " + name + ", use split or compact." );
+   }
+
+   template< class Evaluator >
+   unsigned int evaluateBenchmarkHands( const Evaluator& evaluator, const std::vector< CardSet >& hands )
+   {
+      unsigned int checksum = 0;
+      for( int round = 0; round < BENCHMARK_ROUNDS; ++round ) {
+         for( CardSet hand : hands ) {
+            checksum += evaluator.evaluate( hand );
+         }
+      }
+      return checksum;
+   }
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
-// int  main( int argc, char * argv[] )
-int  main( int , char * [] )
+// Evaluates the same random seven card hands on every thread, either with
+// FiveCardEvaluator in the given table layout or with SuitMaskEvaluator. Run it
+// under perf stat -e L1-dcache-load-misses,LLC-load-misses to compare the layouts.
+void benchmarkEvaluator( const std::string& evaluatorName, TableLayout layout, unsigned int numberOfThreads,
+                         std::uint64_t masterSeed )
+{
+   CardDeck deck( FULL_DECK, masterSeed, 0 );
+   std::vector< CardSet > hands;
+   for( int i = 0; i < BENCHMARK_HANDS; ++i ) {
+      hands.push_back( deck.dealCards( 7 ) );
+      deck.clean();
+   }
+
+   FiveCardEvaluator fiveCardEvaluator( layout );
+   SuitMaskEvaluator suitMaskEvaluator;
+   std::string description;
+   if( evaluatorName == "cactus-kev" ) {
+      description = layout == COMPACT_TABLES ? "cactus-kev, compact tables" : "cactus-kev, split tables";
+   }
+   else if( evaluatorName == "suit-mask" ) {
+      description = "suit-mask";
+   }
+   else {
+      throw std::runtime_error( "Unknown evaluator " + evaluatorName + ", use cactus-kev or suit-mask." );
+   }
+
+   auto start = std::chrono::steady_clock::now();
+   std::vector< std::future< unsigned int > > futureChecksums;
+   for( unsigned int i = 0; i < numberOfThreads; ++i ) {
+      if( evaluatorName == "suit-mask" ) {
+         futureChecksums.push_back( std::async( std::launch::async, evaluateBenchmarkHands< SuitMaskEvaluator >,
+                                                std::cref( suitMaskEvaluator ), std::cref( hands ) ) );
+      }
+      else {
+         futureChecksums.push_back( std::async( std::launch::async, evaluateBenchmarkHands< FiveCardEvaluator >,
+                                                std::cref( fiveCardEvaluator ), std::cref( hands ) ) );
+      }
+   }
+   std::vector< unsigned int > checksums = solveAllFutures( futureChecksums );
+   std::chrono::duration< double > seconds = std::chrono::steady_clock::now() - start;
+
+   double numberOfHands = (double) BENCHMARK_HANDS * BENCHMARK_ROUNDS * numberOfThreads;
+   std::cout << description << ", threads " << numberOfThreads << ": "
+             << numberOfHands / seconds.count() / 1e6 << " million seven card hands per second, checksum "
+             << checksums.front() << std::endl;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// usage: a.out [ --short-deck ] [ --seed=n ]
+//        a.out --benchmark [ --evaluator=cactus-kev|suit-mask ] [ --table-layout=split|compact ] [ --threads=n ] [ --seed=n ]
+int  main( int argc, char * argv[] )
 {
   try {
-    playHoldem( 9 );
+    std::map< std::string, std::string > options = getCommandLineOptions( argc, argv );
+    std::cerr << "Using " << instructionSetName( selectedInstructionSet() ) << " kernels" << std::endl;
+    std::uint64_t masterSeed = options.count( "seed" ) ? std::stoull( options[ "seed" ] ) : RandomStream::randomSeed();
+    std::cerr << "Using seed " << masterSeed << std::endl;
+    if( options.count( "benchmark" ) ) {
+      unsigned int numberOfThreads = options.count( "threads" ) ? std::stoul( options[ "threads" ] )
+        : std::max( 1u, std::thread::hardware_concurrency() );
+      benchmarkEvaluator( options.count( "evaluator" ) ? options[ "evaluator" ] : "cactus-kev",
+                          parseTableLayout( options.count( "table-layout" ) ? options[ "table-layout" ] : "split" ),
+                          numberOfThreads, masterSeed );
+      return 0;
+    }
+
+    playHoldem( 9, options.count( "short-deck" ) ? SHORT_DECK : FULL_DECK, masterSeed );
 
     // FiveCardEvaluator evaluator;
     // 
@@ -0,0 +1,317 @@
+#include <stdexcept>
+
+#include "OmahaEvaluator.h"
+#include "FiveOfSevenCardEvaluator.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// ordered by the higher card, so the pairs of n hole cards are the first n * ( n - 1 ) / 2
+const unsigned int OmahaEvaluator::holePairs[ MAX_OMAHA_HOLE_PAIRS ][ 2 ] = {
+  { 0, 1 }, { 0, 2 }, { 1, 2 }, { 0, 3 }, { 1, 3 }, { 2, 3 }, { 0, 4 }, { 1, 4 }, { 2, 4 }, { 3, 4 },
+  { 0, 5 }, { 1, 5 }, { 2, 5 }, { 3, 5 }, { 4, 5 }
+};
+
+const unsigned int OmahaEvaluator::boardTriples[ 10 ][ 3 ] = {
+  { 0, 1, 2 }, { 0, 1, 3 }, { 0, 1, 4 }, { 0, 2, 3 }, { 0, 2, 4 },
+  { 0, 3, 4 }, { 1, 2, 3 }, { 1, 2, 4 }, { 1, 3, 4 }, { 2, 3, 4 }
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+   struct PartialHand {
+      unsigned int rankBits;
+      unsigned int pattern;   // OmahaTables pair or triple pattern
+      unsigned int suit;
+      unsigned int index;   // of the pair or triple it was made from
+      unsigned int lowRanks;  // ace low rank mask
+      unsigned int numberOfRanks;
+   };
+
+   inline unsigned int rank( unsigned int rawCard ) { return ( rawCard >> 8 ) & 0x0f; }
+
+   // adds the partial hand unless one with the same ranks is already there
+   inline unsigned int addRankPattern( PartialHand patterns[], unsigned int numberOfPatterns, const PartialHand& p )
+   {
+      for( unsigned int i = 0; i < numberOfPatterns; ++i ) {
+         if( patterns[ i ].pattern == p.pattern ) {
+            return numberOfPatterns;
+         }
+      }
+      patterns[ numberOfPatterns ] = p;
+      return numberOfPatterns + 1;
+   }
+
+   // five cards of exactly two ranks are a full house or quads
+   inline bool twoRanks( unsigned int rankBits )
+   {
+      rankBits &= rankBits - 1;
+      return rankBits && !( rankBits & ( rankBits - 1 ) );
+   }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+template< bool WithLow >
+inline unsigned int OmahaEvaluator::evaluate( const unsigned int holeCards[], unsigned int numberOfHoleCards,
+                                              const unsigned int commonCards[ 5 ],
+                                              unsigned int& bestPair, unsigned int& bestTriple, unsigned int& low ) const
+{
+  PartialHand triples[ 10 ];
+  PartialHand pairPatterns[ MAX_OMAHA_HOLE_PAIRS ];
+  PartialHand triplePatterns[ 10 ];
+  PartialHand flushPairs[ MAX_OMAHA_HOLE_PAIRS ];
+  unsigned int numberOfPairPatterns = 0;
+  unsigned int numberOfTriplePatterns = 0;
+  unsigned int numberOfFlushPairs = 0;
+
+  // at most one suit has three or more of the five common cards
+  unsigned int boardRanks = 0;
+  unsigned int flushSuit = 0;
+  for( int i = 0; i < 10; ++i ) {
+    unsigned int a = commonCards[ boardTriples[ i ][ 0 ] ];
+    unsigned int b = commonCards[ boardTriples[ i ][ 1 ] ];
+    unsigned int c = commonCards[ boardTriples[ i ][ 2 ] ];
+    triples[ i ].rankBits = ( a | b | c ) >> 16;
+    triples[ i ].pattern = omahaTables.triplePatterns[ ( rank( a ) * 13 + rank( b ) ) * 13 + rank( c ) ];
+    triples[ i ].suit = a & b & c & 0xf000;
+    triples[ i ].index = i;
+    triples[ i ].lowRanks = LowballEvaluator::aceLowRanks( triples[ i ].rankBits );
+    triples[ i ].numberOfRanks = 1 + ( rank( a ) != rank( b ) ) + ( rank( c ) != rank( a ) && rank( c ) != rank( b ) );
+    boardRanks |= triples[ i ].rankBits;
+    flushSuit |= triples[ i ].suit;
+    numberOfTriplePatterns = addRankPattern( triplePatterns, numberOfTriplePatterns, triples[ i ] );
+  }
+
+  // only pairs in the flush suit can make a flush, all others only count by their ranks
+  unsigned int numberOfPairs = numberOfHoleCards * ( numberOfHoleCards - 1 ) / 2;
+  for( unsigned int i = 0; i < numberOfPairs; ++i ) {
+    unsigned int a = holeCards[ holePairs[ i ][ 0 ] ];
+    unsigned int b = holeCards[ holePairs[ i ][ 1 ] ];
+    PartialHand pair;
+    pair.rankBits = ( a | b ) >> 16;
+    pair.pattern = omahaTables.pairPatterns[ rank( a ) * 13 + rank( b ) ];
+    pair.suit = a & b & flushSuit;
+    pair.index = i;
+    pair.lowRanks = LowballEvaluator::aceLowRanks( pair.rankBits );
+    pair.numberOfRanks = 1 + ( rank( a ) != rank( b ) );
+    if( pair.suit ) {
+      flushPairs[ numberOfFlushPairs++ ] = pair;
+    }
+    numberOfPairPatterns = addRankPattern( pairPatterns, numberOfPairPatterns, pair );
+  }
+
+  unsigned int bestValue = 9999;
+
+  if( numberOfFlushPairs ) {
+    for( int i = 0; i < 10; ++i ) {
+      if( triples[ i ].suit ) {
+        for( unsigned int j = 0; j < numberOfFlushPairs; ++j ) {
+          unsigned int handValue = evaluator_.evaluateFlush( flushPairs[ j ].rankBits | triples[ i ].rankBits );
+          if( handValue < bestValue ) {
+            bestValue = handValue;
+            bestPair = flushPairs[ j ].index;
+            bestTriple = i;
+          }
+        }
+      }
+    }
+  }
+
+  // Without a flush every combination is scored by its ranks: two ranks make a full
+  // house or quads, three at best trips, four a pair and five at best a straight.
+  // So nothing beats a straight flush, a triple of three ranks cannot beat a straight
+  // or better, and against a flush only pairs adding up to two ranks with the triple
+  // can win. With five different ranks on the board that leaves none at all.
+  bool ranksCanWin = bestValue > 10 && ( bestValue == 9999 || __builtin_popcount( boardRanks ) < 5 );
+  if( !ranksCanWin && !WithLow ) {
+    return bestValue;
+  }
+
+  for( unsigned int i = 0; i < numberOfTriplePatterns; ++i ) {
+    const PartialHand& triple = triplePatterns[ i ];
+    bool tripleCanWin = ranksCanWin && ( triple.numberOfRanks < 3 || bestValue > 1600 );
+    // a low takes three different ranks up to the eight from the board
+    bool tripleCanBeLow = WithLow && triple.numberOfRanks == 3 && triple.lowRanks < 0x100;
+    if( !tripleCanWin && !tripleCanBeLow ) {
+      continue;
+    }
+
+    const unsigned short* rankValues = omahaTables.rankValues[ triple.pattern ];
+    for( unsigned int j = 0; j < numberOfPairPatterns; ++j ) {
+      const PartialHand& pair = pairPatterns[ j ];
+      if( tripleCanWin && ( bestValue >= 1600 || twoRanks( pair.rankBits | triple.rankBits ) ) ) {
+        unsigned int handValue = rankValues[ pair.pattern ];
+        if( handValue < bestValue ) {
+          bestValue = handValue;
+          bestPair = pair.index;
+          bestTriple = triple.index;
+        }
+      }
+
+      // and two more up to the eight from the hole cards
+      if( tripleCanBeLow && pair.numberOfRanks == 2 && pair.lowRanks < 0x100 && !( pair.lowRanks & triple.lowRanks ) ) {
+        unsigned int lowValue = lowballTables.aceToFive[ pair.lowRanks | triple.lowRanks ];
+        if( low == NO_LOW || lowValue < low ) {
+          low = lowValue;
+        }
+      }
+    }
+  }
+
+  return bestValue;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int OmahaEvaluator::evaluate( const unsigned int holeCards[], const unsigned int commonCards[ 5 ],
+                                       unsigned int numberOfHoleCards ) const
+{
+  unsigned int bestPair = 0;
+  unsigned int bestTriple = 0;
+  unsigned int low = NO_LOW;
+  return evaluate< false >( holeCards, numberOfHoleCards, commonCards, bestPair, bestTriple, low );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+BestHand OmahaEvaluator::evaluateBestHand( const unsigned int holeCards[], const unsigned int commonCards[ 5 ],
+                                           unsigned int numberOfHoleCards ) const
+{
+  unsigned int bestPair = 0;
+  unsigned int bestTriple = 0;
+  unsigned int low = NO_LOW;
+  BestHand best;
+  best.value = evaluate< false >( holeCards, numberOfHoleCards, commonCards, bestPair, bestTriple, low );
+  for( unsigned int i = 0; i < 2; ++i ) {
+    best.cards.add( Card::cardIndex( holeCards[ holePairs[ bestPair ][ i ] ] ) );
+  }
+  for( unsigned int i = 0; i < 3; ++i ) {
+    best.cards.add( Card::cardIndex( commonCards[ boardTriples[ bestTriple ][ i ] ] ) );
+  }
+  return best;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+HiLoValues OmahaEvaluator::evaluateHiLo( const unsigned int holeCards[], const unsigned int commonCards[ 5 ],
+                                         unsigned int numberOfHoleCards ) const
+{
+  unsigned int bestPair = 0;
+  unsigned int bestTriple = 0;
+  HiLoValues values;
+  values.low = NO_LOW;
+  values.high = evaluate< true >( holeCards, numberOfHoleCards, commonCards, bestPair, bestTriple, values.low );
+  return values;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+   // raw values of 4 to 6 hole cards and 5 common cards, returns the number of hole cards
+   unsigned int omahaRawCards( const Hand& holeCards, const Hand& commonCards,
+                               unsigned int hole[ MAX_OMAHA_HOLE_CARDS ], unsigned int common[ 5 ] )
+   {
+      unsigned int numberOfHoleCards = holeCards.cards().size();
+      if( numberOfHoleCards < 4 || numberOfHoleCards > MAX_OMAHA_HOLE_CARDS || commonCards.cards().size() != 5 ) {
+         throw std::logic_error( "Omaha needs 4 to 6 hole cards and 5 common cards." );
+      }
+
+      for( unsigned int i = 0; i < numberOfHoleCards; ++i ) {
+         hole[ i ] = holeCards.cards()[ i ].raw();
+      }
+      for( int i = 0; i < 5; ++i ) {
+         common[ i ] = commonCards.cards()[ i ].raw();
+      }
+      return numberOfHoleCards;
+   }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int OmahaEvaluator::evaluateOmahaHand( const Hand& holeCards, const Hand& commonCards ) const
+{
+  unsigned int hole[ MAX_OMAHA_HOLE_CARDS ];
+  unsigned int common[ 5 ];
+  unsigned int numberOfHoleCards = omahaRawCards( holeCards, commonCards, hole, common );
+  return evaluate( hole, common, numberOfHoleCards );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+BestHand OmahaEvaluator::evaluateBestOmahaHand( const Hand& holeCards, const Hand& commonCards ) const
+{
+  unsigned int hole[ MAX_OMAHA_HOLE_CARDS ];
+  unsigned int common[ 5 ];
+  unsigned int numberOfHoleCards = omahaRawCards( holeCards, commonCards, hole, common );
+  return evaluateBestHand( hole, common, numberOfHoleCards );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+HiLoValues OmahaEvaluator::evaluateOmahaHiLoHand( const Hand& holeCards, const Hand& commonCards ) const
+{
+  unsigned int hole[ MAX_OMAHA_HOLE_CARDS ];
+  unsigned int common[ 5 ];
+  unsigned int numberOfHoleCards = omahaRawCards( holeCards, commonCards, hole, common );
+  return evaluateHiLo( hole, common, numberOfHoleCards );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+void OmahaEvaluator::equity( const CardSet holeCards[], unsigned int numberOfSeats, CardSet commonCards,
+                             unsigned int numberOfTrials, CardDeck& deck, double equities[] ) const
+{
+  if( numberOfSeats == 0 || numberOfSeats > MAX_SEATS || commonCards.size() > 5 || numberOfTrials == 0 ) {
+    throw std::logic_error( "Omaha equity needs 1 to 10 seats, at most 5 common cards and one trial or more." );
+  }
+
+  // the trials deal from a deck of their own, locking every known card in it
+  // also rejects cards given twice
+  CardDeck trialDeck = deck.split();
+  unsigned int cardIndices[ CARDS_IN_DECK ];
+  unsigned int numberOfCommonCards = commonCards.indices( cardIndices );
+  for( unsigned int i = 0; i < numberOfCommonCards; ++i ) {
+    trialDeck.lockCard( cardIndices[ i ] );
+  }
+
+  unsigned int hole[ MAX_SEATS ][ MAX_OMAHA_HOLE_CARDS ];
+  unsigned int numberOfHoleCards[ MAX_SEATS ];
+  for( unsigned int seat = 0; seat < numberOfSeats; ++seat ) {
+    numberOfHoleCards[ seat ] = holeCards[ seat ].size();
+    if( numberOfHoleCards[ seat ] < 4 || numberOfHoleCards[ seat ] > MAX_OMAHA_HOLE_CARDS ) {
+      throw std::logic_error( "Omaha needs 4 to 6 hole cards." );
+    }
+    holeCards[ seat ].indices( hole[ seat ] );
+    for( unsigned int i = 0; i < numberOfHoleCards[ seat ]; ++i ) {
+      trialDeck.lockCard( hole[ seat ][ i ] );
+      hole[ seat ][ i ] = Card::rawCard( hole[ seat ][ i ] );
+    }
+    equities[ seat ] = 0.0;
+  }
+
+  for( unsigned int trial = 0; trial < numberOfTrials; ++trial ) {
+    CardSet board = commonCards | trialDeck.dealCards( 5 - numberOfCommonCards );
+    trialDeck.clean();
+
+    unsigned int common[ 5 ];
+    board.indices( common );
+    for( unsigned int i = 0; i < 5; ++i ) {
+      common[ i ] = Card::rawCard( common[ i ] );
+    }
+
+    ShowdownResult result;
+    for( unsigned int seat = 0; seat < numberOfSeats; ++seat ) {
+      result.values[ seat ] = evaluate( hole[ seat ], common, numberOfHoleCards[ seat ] );
+    }
+
+    result.settle( numberOfSeats );
+    for( unsigned int seat = 0; seat < numberOfSeats; ++seat ) {
+      equities[ seat ] += result.shares[ seat ];
+    }
+  }
+
+  for( unsigned int seat = 0; seat < numberOfSeats; ++seat ) {
+    equities[ seat ] /= numberOfTrials;
+  }
+}
@@ -0,0 +1,121 @@
+#ifndef POKER_OMAHA_EVALUATOR_H
+#define POKER_OMAHA_EVALUATOR_H
+
+#include "FiveCardEvaluator.h"
+#include "LowballEvaluator.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Both halves of an Omaha Hi/Lo hand: the high value on the FiveCardEvaluator
+// scale and the eight or better low on the ace to five scale, NO_LOW if the
+// hand has no qualifying low.
+struct HiLoValues {
+   unsigned int high;
+   unsigned int low;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#define MAX_OMAHA_HOLE_CARDS 6
+#define MAX_OMAHA_HOLE_PAIRS 15
+#define OMAHA_PAIR_PATTERNS 91       // multisets of two ranks
+#define OMAHA_TRIPLE_PATTERNS 455    // multisets of three ranks
+
+// Side tables of OmahaEvaluator. Off the flush suit a hole card pair and a board
+// triple only count by their ranks, so the value of every pair rank pattern with
+// every triple rank pattern is stored up front and scoring one is a single load,
+// no prime product and no perfect hash. pairPatterns and triplePatterns number
+// the patterns by the ranks of the cards in any order; the impossible five of a
+// kind entries stay 0. Flushes come from the FiveCardEvaluator flushes table,
+// which is already indexed by the rank mask.
+struct OmahaTables {
+   unsigned char pairPatterns[ 13 * 13 ];
+   unsigned short triplePatterns[ 13 * 13 * 13 ];
+   unsigned short rankValues[ OMAHA_TRIPLE_PATTERNS ][ OMAHA_PAIR_PATTERNS ];
+
+   constexpr OmahaTables()
+     : pairPatterns(), triplePatterns(), rankValues()
+   {
+      unsigned int numberOfPairPatterns = 0;
+      for( unsigned int a = 0; a < 13; ++a ) {
+         for( unsigned int b = a; b < 13; ++b ) {
+            pairPatterns[ a * 13 + b ] = pairPatterns[ b * 13 + a ] = numberOfPairPatterns++;
+         }
+      }
+
+      unsigned int numberOfTriplePatterns = 0;
+      for( unsigned int a = 0; a < 13; ++a ) {
+         for( unsigned int b = a; b < 13; ++b ) {
+            for( unsigned int c = b; c < 13; ++c ) {
+               unsigned int pattern = numberOfTriplePatterns++;
+               triplePatterns[ ( a * 13 + b ) * 13 + c ] = triplePatterns[ ( a * 13 + c ) * 13 + b ] = pattern;
+               triplePatterns[ ( b * 13 + a ) * 13 + c ] = triplePatterns[ ( b * 13 + c ) * 13 + a ] = pattern;
+               triplePatterns[ ( c * 13 + a ) * 13 + b ] = triplePatterns[ ( c * 13 + b ) * 13 + a ] = pattern;
+
+               for( unsigned int d = 0; d < 13; ++d ) {
+                  for( unsigned int e = d; e < 13; ++e ) {
+                     if( a == c && a == d && a == e ) {
+                        continue;
+                     }
+                     unsigned int rankBits = ( 1 << a ) | ( 1 << b ) | ( 1 << c ) | ( 1 << d ) | ( 1 << e );
+                     rankValues[ pattern ][ pairPatterns[ d * 13 + e ] ] = __builtin_popcount( rankBits ) == 5
+                        ? fiveCardEvaluatorTables.unique5[ rankBits ]
+                        : fiveCardEvaluatorTables.hashValues[ FiveCardEvaluatorTables::findFast(
+                             FiveCardEvaluatorTables::prime( a ) * FiveCardEvaluatorTables::prime( b ) * FiveCardEvaluatorTables::prime( c )
+                             * FiveCardEvaluatorTables::prime( d ) * FiveCardEvaluatorTables::prime( e ) ) ];
+                  }
+               }
+            }
+         }
+      }
+   }
+};
+
+inline constexpr OmahaTables omahaTables;
+
+// Omaha evaluator for 4, 5 or 6 hole cards (PLO, PLO5, PLO6) working directly on
+// Card::raw() values. The rank bits, prime products and common suit of the hole
+// card pairs and 10 board triples are computed once per call, then the 60, 100
+// or 150 combinations are scored from OmahaTables with pruning:
+// pairs or triples with the same ranks are scored once, flushes are only tried
+// for pairs in the one suit with three or more common cards, and the rank
+// combinations are skipped when the best category they can reach (from the
+// number of different ranks in the pair and triple) cannot beat the best so far.
+// Results are identical to FiveCardEvaluator::evaluateOmahaHand.
+class OmahaEvaluator {
+private:
+   static const unsigned int holePairs[ MAX_OMAHA_HOLE_PAIRS ][ 2 ];
+   static const unsigned int boardTriples[ 10 ][ 3 ];
+
+   FiveCardEvaluator evaluator_;
+
+   template< bool WithLow >
+   unsigned int evaluate( const unsigned int holeCards[], unsigned int numberOfHoleCards, const unsigned int commonCards[ 5 ],
+                          unsigned int& bestPair, unsigned int& bestTriple, unsigned int& low ) const;
+
+public:
+   unsigned int evaluate( const unsigned int holeCards[], const unsigned int commonCards[ 5 ],
+                          unsigned int numberOfHoleCards = 4 ) const;
+   unsigned int evaluateOmahaHand( const Hand& holeCards, const Hand& commonCards ) const;
+
+   // The value plus the hole card pair and board triple making it, found by
+   // remembering the best combination while scoring.
+   BestHand evaluateBestHand( const unsigned int holeCards[], const unsigned int commonCards[ 5 ],
+                              unsigned int numberOfHoleCards = 4 ) const;
+   BestHand evaluateBestOmahaHand( const Hand& holeCards, const Hand& commonCards ) const;
+
+   // Omaha Hi/Lo: the low is found in the same sweep over the pairs and triples
+   // as the high value, from the ace low rank masks of the two parts.
+   HiLoValues evaluateHiLo( const unsigned int holeCards[], const unsigned int commonCards[ 5 ],
+                            unsigned int numberOfHoleCards = 4 ) const;
+   HiLoValues evaluateOmahaHiLoHand( const Hand& holeCards, const Hand& commonCards ) const;
+
+   // Monte Carlo equity of 1 to MAX_SEATS hands of 4 to 6 hole cards each. The
+   // given common cards are kept, the rest of the board is dealt for every trial,
+   // and equities[ seat ] gets the seat's average share of the pot. The boards
+   // come from deck.split(), so deck itself only gives up two random numbers.
+   void equity( const CardSet holeCards[], unsigned int numberOfSeats, CardSet commonCards,
+                unsigned int numberOfTrials, CardDeck& deck, double equities[] ) const;
+};
+
+#endif
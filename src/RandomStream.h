@@ -0,0 +1,78 @@
+#ifndef POKER_RANDOM_STREAM_H
+#define POKER_RANDOM_STREAM_H
+
+#include <cstdint>
+#include <chrono>
+#include <atomic>
+#include <random>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// xoshiro256** by Blackman and Vigna: 32 bytes of state, a few cycles per 64 bit
+// number. A stream is fully given by a master seed and a stream id, both are
+// hashed by splitmix64 into the state, so the streams of one master seed are
+// independent and a simulation that gives every work unit its own stream id
+// replays bit for bit however many threads run it.
+//
+// Satisfies UniformRandomBitGenerator, so it also works with the std
+// distributions.
+class RandomStream {
+private:
+   std::uint64_t state_[ 4 ];
+
+   static inline std::uint64_t rotateLeft( std::uint64_t x, int k ) { return ( x << k ) | ( x >> ( 64 - k ) ); }
+
+public:
+   typedef std::uint64_t result_type;
+
+   static inline std::uint64_t splitMix64( std::uint64_t& x )
+   {
+      std::uint64_t z = ( x += 0x9e3779b97f4a7c15ULL );
+      z = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+      z = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111ebULL;
+      return z ^ ( z >> 31 );
+   }
+
+   // A master seed for runs that are not replayed. Mixes the clock, the random
+   // device and a counter, so calls in the same clock tick still differ.
+   static std::uint64_t randomSeed()
+   {
+      static std::atomic< std::uint64_t > counter( 0 );
+      std::uint64_t x = std::chrono::high_resolution_clock::now().time_since_epoch().count() + counter++;
+      return splitMix64( x ) ^ ( std::uint64_t( std::random_device()() ) << 32 );
+   }
+
+   // The stream id is mixed into the hashed master seed and hashed again, so
+   // swapping seed and id gives another stream and neighbouring ids do not
+   // share splitmix64 outputs.
+   RandomStream( std::uint64_t masterSeed, std::uint64_t streamId = 0 )
+   {
+      std::uint64_t x = masterSeed;
+      x = splitMix64( x ) ^ ( streamId * 0x9e3779b97f4a7c15ULL );
+      x = splitMix64( x );
+      for( int i = 0; i < 4; ++i ) {
+         state_[ i ] = splitMix64( x );
+      }
+   }
+
+   static constexpr result_type min() { return 0; }
+   static constexpr result_type max() { return ~std::uint64_t( 0 ); }
+
+   inline std::uint64_t operator()()
+   {
+      std::uint64_t result = rotateLeft( state_[ 1 ] * 5, 7 ) * 9;
+      std::uint64_t t = state_[ 1 ] << 17;
+      state_[ 2 ] ^= state_[ 0 ];
+      state_[ 3 ] ^= state_[ 1 ];
+      state_[ 1 ] ^= state_[ 2 ];
+      state_[ 0 ] ^= state_[ 3 ];
+      state_[ 2 ] ^= t;
+      state_[ 3 ] = rotateLeft( state_[ 3 ], 45 );
+      return result;
+   }
+
+   // the upper half, the better bits of xoshiro
+   inline std::uint32_t next32() { return std::uint32_t( operator()() >> 32 ); }
+};
+
+#endif
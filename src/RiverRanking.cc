@@ -0,0 +1,144 @@
+#include <stdexcept>
+
+#include "RiverRanking.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+RiverRanking::RiverRanking( const FiveOfSevenCardEvaluator& evaluator, CardSet board )
+  : board_( board )
+{
+  if( board.size() != 5 ) {
+    throw std::logic_error( "River rankings need 5 common cards." );
+  }
+
+  PreparedBoard preparedBoard = evaluator.prepareBoard( board );
+
+  unsigned int holeCards1[ RIVER_HOLE_CARD_COMBINATIONS ];
+  unsigned int holeCards2[ RIVER_HOLE_CARD_COMBINATIONS ];
+  unsigned short values[ RIVER_HOLE_CARD_COMBINATIONS ];
+  unsigned int liveCards[ CARDS_IN_DECK ];
+  unsigned int numberOfLiveCards = CardSet( ~board.mask() & ( ( 1ULL << CARDS_IN_DECK ) - 1 ) ).indices( liveCards );
+  std::size_t numberOfHands = 0;
+  for( unsigned int i = 0; i < numberOfLiveCards; ++i ) {
+    for( unsigned int j = i + 1; j < numberOfLiveCards; ++j ) {
+      holeCards1[ numberOfHands ] = liveCards[ i ];
+      holeCards2[ numberOfHands ] = liveCards[ j ];
+      ++numberOfHands;
+    }
+  }
+
+  evaluator.evaluateHoldemHands( preparedBoard, holeCards1, holeCards2, numberOfHands, values );
+
+  // stable radix sort on the 13 bit values, low byte first
+  std::vector< RankedHoleCards > unsorted( numberOfHands );
+  for( std::size_t i = 0; i < numberOfHands; ++i ) {
+    RankedHoleCards& hand = unsorted[ i ];
+    hand.cards = CardSet( ( 1ULL << holeCards1[ i ] ) | ( 1ULL << holeCards2[ i ] ) );
+    hand.value = values[ i ];
+  }
+  rankedHoleCards_.resize( numberOfHands );
+  for( unsigned int shift = 0; shift < 16; shift += 8 ) {
+    std::size_t offsets[ 256 ] = { 0 };
+    for( const RankedHoleCards& hand : unsorted ) {
+      ++offsets[ ( hand.value >> shift ) & 0xff ];
+    }
+    std::size_t sum = 0;
+    for( std::size_t& offset : offsets ) {
+      std::size_t count = offset;
+      offset = sum;
+      sum += count;
+    }
+    for( const RankedHoleCards& hand : unsorted ) {
+      rankedHoleCards_[ offsets[ ( hand.value >> shift ) & 0xff ]++ ] = hand;
+    }
+    if( shift == 0 ) {
+      unsorted.swap( rankedHoleCards_ );
+    }
+  }
+
+  // Walk from the worst group of equal values to the best one, counting the hands
+  // seen so far per card. Every live card is in 46 holdings, so each hand has
+  // 1081 - 91 = 990 opponent holdings which do not share a card with it.
+  unsigned int worse = 0;
+  unsigned int worsePerCard[ CARDS_IN_DECK ] = { 0 };
+  unsigned int groupPerCard[ CARDS_IN_DECK ] = { 0 };
+  unsigned int opponents = numberOfHands - 2 * ( numberOfLiveCards - 1 ) + 1;
+  std::size_t groupEnd = numberOfHands;
+  while( groupEnd > 0 ) {
+    std::size_t groupBegin = groupEnd - 1;
+    while( groupBegin > 0 && rankedHoleCards_[ groupBegin - 1 ].value == rankedHoleCards_[ groupEnd - 1 ].value ) {
+      --groupBegin;
+    }
+
+    for( std::size_t i = groupBegin; i < groupEnd; ++i ) {
+      std::uint64_t mask = rankedHoleCards_[ i ].cards.mask();
+      ++groupPerCard[ __builtin_ctzll( mask ) ];
+      ++groupPerCard[ 63 - __builtin_clzll( mask ) ];
+    }
+
+    for( std::size_t i = groupBegin; i < groupEnd; ++i ) {
+      RankedHoleCards& hand = rankedHoleCards_[ i ];
+      unsigned int card1 = __builtin_ctzll( hand.cards.mask() );
+      unsigned int card2 = 63 - __builtin_clzll( hand.cards.mask() );
+      hand.wins = worse - worsePerCard[ card1 ] - worsePerCard[ card2 ];
+      hand.ties = ( groupEnd - groupBegin ) - groupPerCard[ card1 ] - groupPerCard[ card2 ] + 1;
+      hand.losses = opponents - hand.wins - hand.ties;
+    }
+
+    // move the group into the worse counts and clear its card counts
+    worse += groupEnd - groupBegin;
+    for( std::size_t i = groupBegin; i < groupEnd; ++i ) {
+      std::uint64_t mask = rankedHoleCards_[ i ].cards.mask();
+      unsigned int card1 = __builtin_ctzll( mask );
+      unsigned int card2 = 63 - __builtin_clzll( mask );
+      worsePerCard[ card1 ] += groupPerCard[ card1 ];
+      worsePerCard[ card2 ] += groupPerCard[ card2 ];
+      groupPerCard[ card1 ] = 0;
+      groupPerCard[ card2 ] = 0;
+    }
+    groupEnd = groupBegin;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+RiverRankingCache::RiverRankingCache( std::shared_ptr< FiveOfSevenCardEvaluator > evaluator, std::size_t capacity )
+  : evaluator_( evaluator ),
+    capacity_( capacity )
+{
+  if( capacity_ == 0 ) {
+    throw std::logic_error( "River ranking cache needs a capacity of at least one board." );
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+std::shared_ptr< const RiverRanking > RiverRankingCache::ranking( CardSet board )
+{
+  {
+    std::lock_guard< std::mutex > lock( mutex_ );
+    auto it = index_.find( board.mask() );
+    if( it != index_.end() ) {
+      rankings_.splice( rankings_.begin(), rankings_, it->second );
+      return *it->second;
+    }
+  }
+
+  std::shared_ptr< const RiverRanking > ranking = std::make_shared< RiverRanking >( *evaluator_, board );
+
+  std::lock_guard< std::mutex > lock( mutex_ );
+  auto it = index_.find( board.mask() );
+  if( it != index_.end() ) {
+    // another thread was faster
+    return *it->second;
+  }
+
+  rankings_.push_front( ranking );
+  index_[ board.mask() ] = rankings_.begin();
+  if( rankings_.size() > capacity_ ) {
+    index_.erase( rankings_.back()->board().mask() );
+    rankings_.pop_back();
+  }
+
+  return ranking;
+}
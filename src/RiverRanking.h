@@ -0,0 +1,64 @@
+#ifndef POKER_RIVER_RANKING_H
+#define POKER_RIVER_RANKING_H
+
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <cstddef>
+#include <cstdint>
+#include "CardDeck.h"
+#include "FiveOfSevenCardEvaluator.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#define HOLE_CARD_COMBINATIONS 1326
+#define RIVER_HOLE_CARD_COMBINATIONS 1081
+
+// One hole card pair on a river board. The counts cover all opponent holdings
+// which do not share a card with this one, i.e. blocked holdings are left out.
+struct RankedHoleCards {
+   CardSet cards;
+   unsigned short value;      // Hold'em value on the board, lower is better
+   unsigned short wins;
+   unsigned short ties;
+   unsigned short losses;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// All 1081 hole card pairs which do not collide with a 5 card board, best first.
+class RiverRanking {
+private:
+   CardSet board_;
+   std::vector< RankedHoleCards > rankedHoleCards_;
+
+public:
+   RiverRanking( const FiveOfSevenCardEvaluator& evaluator, CardSet board );
+
+   inline CardSet board() const { return board_; }
+   inline const std::vector< RankedHoleCards >& rankedHoleCards() const { return rankedHoleCards_; }
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Keeps the rankings of the most recently used boards. Safe to share between
+// worker threads; a ranking is computed outside the lock.
+class RiverRankingCache {
+private:
+   typedef std::list< std::shared_ptr< const RiverRanking > > Rankings;
+
+   std::shared_ptr< FiveOfSevenCardEvaluator > evaluator_;
+   std::size_t capacity_;
+   std::mutex mutex_;
+   Rankings rankings_;   // most recently used first
+   std::unordered_map< std::uint64_t, Rankings::iterator > index_;
+
+public:
+   RiverRankingCache( std::shared_ptr< FiveOfSevenCardEvaluator > evaluator, std::size_t capacity = 1024 );
+
+   std::shared_ptr< const RiverRanking > ranking( CardSet board );
+};
+
+#endif
@@ -0,0 +1,1162 @@
+// Self check of the evaluators against FiveCardEvaluator and brute force, run by
+// make check once per instruction set. Every check prints its name and the number
+// of mismatches, the exit code is 1 if any check failed.
+//
+// usage: selfCheck [ lookup table file ]
+#include <iostream>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <memory>
+
+#include "FiveCardEvaluator.h"
+#include "FiveOfSevenCardEvaluator.h"
+#include "LookupTableEvaluator.h"
+#include "OmahaEvaluator.h"
+#include "RiverRanking.h"
+#include "SuitMaskEvaluator.h"
+#include "ShortDeckEvaluator.h"
+#include "LowballEvaluator.h"
+#include "StudEvaluator.h"
+#include "RandomStream.h"
+#include "BoardSampler.h"
+#include "CombinationIndex.h"
+#include "EquityEnumerator.h"
+#include "CpuDispatch.h"
+
+#define SELF_CHECK_SEED 20240601
+#define RANDOM_HANDS 100000
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int failedChecks = 0;
+
+void report( const char* name, std::size_t mismatches )
+{
+   std::cout << name << ": " << ( mismatches ? "FAILED, " : "ok, " ) << mismatches << " mismatches" << std::endl;
+   failedChecks += mismatches != 0;
+}
+
+unsigned int toRawCards( CardSet cards, unsigned int rawCards[] )
+{
+   unsigned int numberOfCards = cards.indices( rawCards );
+   for( unsigned int i = 0; i < numberOfCards; ++i ) {
+      rawCards[ i ] = Card::rawCard( rawCards[ i ] );
+   }
+   return numberOfCards;
+}
+
+// best value of all 5 card subsets of 5 to 7 raw cards under evaluate
+template< class Evaluate >
+unsigned int bestFiveCardSubset( const unsigned int rawCards[], unsigned int numberOfCards, Evaluate evaluate )
+{
+   unsigned int bestValue = 0xffff;
+   for( unsigned int skipped = 0; skipped < ( 1u << numberOfCards ); ++skipped ) {
+      if( __builtin_popcount( skipped ) != numberOfCards - 5 ) {
+         continue;
+      }
+      unsigned int subset[ 5 ];
+      unsigned int n = 0;
+      for( unsigned int i = 0; i < numberOfCards; ++i ) {
+         if( !( ( skipped >> i ) & 1 ) ) {
+            subset[ n++ ] = rawCards[ i ];
+         }
+      }
+      bestValue = std::min( bestValue, evaluate( subset ) );
+   }
+   return bestValue;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+void checkSevenCardHands()
+{
+   FiveCardEvaluator evaluator;
+   FiveOfSevenCardEvaluator fiveOfSevenEvaluator;
+   CardDeck deck( FULL_DECK, SELF_CHECK_SEED, 1 );
+
+   std::size_t mismatches = 0;
+   for( unsigned int i = 0; i < RANDOM_HANDS; ++i ) {
+      CardSet holeCards = deck.dealCards( 2 );
+      CardSet commonCards = deck.dealCards( 5 );
+      deck.clean();
+      unsigned int value = evaluator.evaluate( holeCards | commonCards );
+      mismatches += fiveOfSevenEvaluator.evaluate( holeCards | commonCards ) != value;
+      mismatches += fiveOfSevenEvaluator.evaluateHoldemHand( holeCards, commonCards ) != value;
+   }
+
+   report( "seven cards, FiveOfSevenCardEvaluator", mismatches );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+void checkOmahaHands()
+{
+   FiveCardEvaluator evaluator;
+   OmahaEvaluator omahaEvaluator;
+   CardDeck deck( FULL_DECK, SELF_CHECK_SEED, 4 );
+
+   // PLO, PLO5 and PLO6 in turn
+   std::size_t mismatches = 0;
+   for( unsigned int i = 0; i < RANDOM_HANDS / 4; ++i ) {
+      unsigned int numberOfHoleCards = 4 + i % 3;
+      CardSet holeCards = deck.dealCards( numberOfHoleCards );
+      CardSet commonCards = deck.dealCards( 5 );
+      deck.clean();
+
+      unsigned int hole[ MAX_OMAHA_HOLE_CARDS ];
+      unsigned int common[ 5 ];
+      toRawCards( holeCards, hole );
+      toRawCards( commonCards, common );
+      mismatches += omahaEvaluator.evaluate( hole, common, numberOfHoleCards ) != evaluator.evaluateOmahaHand( holeCards.toHand(), commonCards.toHand() );
+   }
+
+   report( "Omaha, high", mismatches );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+void checkBatchEvaluation()
+{
+   FiveCardEvaluator evaluator;
+   CardDeck deck( FULL_DECK, SELF_CHECK_SEED, 2 );
+
+   std::size_t mismatches = 0;
+   for( unsigned int cardsPerHand = 5; cardsPerHand <= 7; ++cardsPerHand ) {
+      // not a multiple of 16, so the scalar remainder runs as well
+      const std::size_t numberOfHands = 10007;
+      std::vector< unsigned int > rawCards( cardsPerHand * numberOfHands );
+      std::vector< CardSet > hands( numberOfHands );
+      for( std::size_t i = 0; i < numberOfHands; ++i ) {
+         unsigned int handCards[ 7 ];
+         hands[ i ] = deck.dealCards( cardsPerHand );
+         deck.clean();
+         toRawCards( hands[ i ], handCards );
+         for( unsigned int c = 0; c < cardsPerHand; ++c ) {
+            rawCards[ c * numberOfHands + i ] = handCards[ c ];
+         }
+      }
+
+      std::vector< unsigned short > values( numberOfHands );
+      evaluator.evaluateBatch( rawCards.data(), cardsPerHand, numberOfHands, values.data() );
+      for( std::size_t i = 0; i < numberOfHands; ++i ) {
+         mismatches += values[ i ] != evaluator.evaluate( hands[ i ] );
+      }
+   }
+
+   report( "batch evaluation", mismatches );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Random values from a narrow range, so most blocks have ties of every size, and
+// the last trials padded as lost ones.
+void checkShowdownBlocks()
+{
+   RandomStream stream( SELF_CHECK_SEED, 11 );
+
+   std::size_t mismatches = 0;
+   for( unsigned int numberOfOpponents = 0; numberOfOpponents < MAX_SEATS; ++numberOfOpponents ) {
+      unsigned short heroValues[ SHOWDOWN_BLOCK_SIZE ];
+      std::vector< unsigned short > opponentValues( numberOfOpponents * SHOWDOWN_BLOCK_SIZE );
+      unsigned int expectedTiedWins[ MAX_SEATS ] = { 0 };
+      for( unsigned int i = 0; i < SHOWDOWN_BLOCK_SIZE; ++i ) {
+         bool padded = i >= SHOWDOWN_BLOCK_SIZE - 100;
+         ShowdownResult result;
+         result.values[ 0 ] = heroValues[ i ] = padded ? 0xffff : 1 + stream.next32() % 4;
+         for( unsigned int j = 0; j < numberOfOpponents; ++j ) {
+            result.values[ j + 1 ] = opponentValues[ j * SHOWDOWN_BLOCK_SIZE + i ] = padded ? 0 : 1 + stream.next32() % 4;
+         }
+         result.settle( numberOfOpponents + 1 );
+         if( result.winners & 1 ) {
+            ++expectedTiedWins[ result.numberOfWinners - 1 ];
+         }
+      }
+
+      unsigned int tiedWins[ MAX_SEATS ];
+      settleShowdownBlock( heroValues, opponentValues.data(), numberOfOpponents, tiedWins );
+      for( unsigned int t = 0; t < MAX_SEATS; ++t ) {
+         mismatches += tiedWins[ t ] != expectedTiedWins[ t ];
+      }
+   }
+
+   report( "showdown blocks", mismatches );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// All hole card pairs on flops, turns and rivers: evaluateHoldemHands against
+// evaluateHoldemHand on the prepared board, and that against FiveCardEvaluator.
+void checkHoldemHands()
+{
+   FiveCardEvaluator fiveCardEvaluator;
+   FiveOfSevenCardEvaluator evaluator;
+   CardDeck deck( FULL_DECK, SELF_CHECK_SEED, 3 );
+
+   std::size_t mismatches = 0;
+   for( unsigned int round = 0; round < 100; ++round ) {
+      PreparedBoard board = evaluator.prepareBoard( deck.dealCards( 3 + round % 3 ) );
+      CardSet liveCards( ( ( 1ULL << CARDS_IN_DECK ) - 1 ) & ~board.cards().mask() );
+      deck.clean();
+
+      unsigned int holeCards1[ 1326 ];
+      unsigned int holeCards2[ 1326 ];
+      std::size_t numberOfHands = 0;
+      for( unsigned int card1 = 0; card1 < CARDS_IN_DECK; ++card1 ) {
+         for( unsigned int card2 = card1 + 1; card2 < CARDS_IN_DECK; ++card2 ) {
+            if( liveCards.contains( card1 ) && liveCards.contains( card2 ) ) {
+               holeCards1[ numberOfHands ] = card1;
+               holeCards2[ numberOfHands++ ] = card2;
+            }
+         }
+      }
+
+      unsigned short values[ 1326 ];
+      evaluator.evaluateHoldemHands( board, holeCards1, holeCards2, numberOfHands, values );
+      for( std::size_t i = 0; i < numberOfHands; ++i ) {
+         CardSet holeCards;
+         holeCards.add( holeCards1[ i ] );
+         holeCards.add( holeCards2[ i ] );
+         unsigned int value = evaluator.evaluateHoldemHand( board, holeCards1[ i ], holeCards2[ i ] );
+         mismatches += values[ i ] != value;
+         mismatches += fiveCardEvaluator.evaluate( board.cards() | holeCards ) != value;
+      }
+   }
+
+   report( "Hold'em hands on a prepared board", mismatches );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Rankings of random river boards against a loop over all pairs of the 1081 hole
+// card pairs, then the cache: a hit, another board and an eviction.
+void checkRiverRankings()
+{
+   FiveCardEvaluator evaluator;
+   std::shared_ptr< FiveOfSevenCardEvaluator > fiveOfSevenEvaluator( new FiveOfSevenCardEvaluator() );
+   CardDeck deck( FULL_DECK, SELF_CHECK_SEED, 12 );
+
+   std::size_t mismatches = 0;
+   std::size_t countMismatches = 0;
+   for( unsigned int round = 0; round < 5; ++round ) {
+      CardSet board = deck.dealCards( 5 );
+      deck.clean();
+      RiverRanking ranking( *fiveOfSevenEvaluator, board );
+      const std::vector< RankedHoleCards >& ranked = ranking.rankedHoleCards();
+
+      std::vector< std::pair< CardSet, unsigned int > > holdings;
+      for( unsigned int card1 = 0; card1 < CARDS_IN_DECK; ++card1 ) {
+         for( unsigned int card2 = card1 + 1; card2 < CARDS_IN_DECK; ++card2 ) {
+            CardSet holeCards( ( 1ULL << card1 ) | ( 1ULL << card2 ) );
+            if( !( board.mask() & holeCards.mask() ) ) {
+               holdings.push_back( std::make_pair( holeCards, evaluator.evaluate( board | holeCards ) ) );
+            }
+         }
+      }
+      mismatches += ranked.size() != RIVER_HOLE_CARD_COMBINATIONS || holdings.size() != RIVER_HOLE_CARD_COMBINATIONS;
+
+      std::vector< unsigned int > values;
+      for( const auto& holding : holdings ) {
+         values.push_back( holding.second );
+      }
+      std::sort( values.begin(), values.end() );
+      for( std::size_t i = 0; i < ranked.size() && i < values.size(); ++i ) {
+         mismatches += ranked[ i ].value != values[ i ];
+      }
+
+      for( const RankedHoleCards& hand : ranked ) {
+         unsigned int wins = 0;
+         unsigned int ties = 0;
+         unsigned int losses = 0;
+         for( const auto& holding : holdings ) {
+            if( !( holding.first.mask() & hand.cards.mask() ) ) {
+               wins += hand.value < holding.second;
+               ties += hand.value == holding.second;
+               losses += hand.value > holding.second;
+            }
+         }
+         mismatches += hand.wins != wins || hand.ties != ties || hand.losses != losses;
+         countMismatches += hand.wins + hand.ties + hand.losses != 990;
+      }
+   }
+   report( "river rankings", mismatches );
+   report( "river rankings, 990 opponents per hand", countMismatches );
+
+   RiverRankingCache cache( fiveOfSevenEvaluator, 2 );
+   CardSet boards[ 3 ];
+   for( CardSet& board : boards ) {
+      board = deck.dealCards( 5 );
+      deck.clean();
+   }
+   std::size_t cacheMismatches = 0;
+   std::shared_ptr< const RiverRanking > first = cache.ranking( boards[ 0 ] );
+   cacheMismatches += cache.ranking( boards[ 0 ] ) != first;
+   std::shared_ptr< const RiverRanking > second = cache.ranking( boards[ 1 ] );
+   cacheMismatches += second == first || second->board() != boards[ 1 ];
+   std::shared_ptr< const RiverRanking > third = cache.ranking( boards[ 2 ] );
+   // the first board was the least recently used, so it is computed again
+   std::shared_ptr< const RiverRanking > again = cache.ranking( boards[ 0 ] );
+   cacheMismatches += again == first || again->board() != boards[ 0 ];
+   cacheMismatches += again->rankedHoleCards().front().value != first->rankedHoleCards().front().value;
+   cacheMismatches += cache.ranking( boards[ 2 ] ) != third;
+   report( "river ranking cache", cacheMismatches );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// All 2598960 five card hands.
+void checkFiveCardHands()
+{
+   FiveCardEvaluator evaluator;
+   FiveCardEvaluator compactEvaluator( COMPACT_TABLES );
+   FiveOfSevenCardEvaluator fiveOfSevenEvaluator;
+
+   std::size_t compactMismatches = 0;
+   std::size_t suitMaskMismatches = 0;
+   std::size_t fiveOfSevenMismatches = 0;
+   unsigned int c[ 5 ];
+   for( c[ 0 ] = 0; c[ 0 ] < CARDS_IN_DECK; ++c[ 0 ] ) {
+      for( c[ 1 ] = c[ 0 ] + 1; c[ 1 ] < CARDS_IN_DECK; ++c[ 1 ] ) {
+         for( c[ 2 ] = c[ 1 ] + 1; c[ 2 ] < CARDS_IN_DECK; ++c[ 2 ] ) {
+            for( c[ 3 ] = c[ 2 ] + 1; c[ 3 ] < CARDS_IN_DECK; ++c[ 3 ] ) {
+               for( c[ 4 ] = c[ 3 ] + 1; c[ 4 ] < CARDS_IN_DECK; ++c[ 4 ] ) {
+                  unsigned int rawCards[ 5 ];
+                  CardSet hand;
+                  for( int i = 0; i < 5; ++i ) {
+                     rawCards[ i ] = Card::rawCard( c[ i ] );
+                     hand.add( c[ i ] );
+                  }
+                  unsigned int value = evaluator.evaluate( rawCards[ 0 ], rawCards[ 1 ], rawCards[ 2 ], rawCards[ 3 ], rawCards[ 4 ] );
+                  compactMismatches += compactEvaluator.evaluate( rawCards[ 0 ], rawCards[ 1 ], rawCards[ 2 ], rawCards[ 3 ],
+                                                                  rawCards[ 4 ] ) != value;
+                  suitMaskMismatches += SuitMaskEvaluator::evaluate( hand ) != value;
+                  fiveOfSevenMismatches += fiveOfSevenEvaluator.evaluate( hand ) != value;
+               }
+            }
+         }
+      }
+   }
+
+   report( "five cards, compact tables", compactMismatches );
+   report( "five cards, SuitMaskEvaluator", suitMaskMismatches );
+   report( "five cards, FiveOfSevenCardEvaluator", fiveOfSevenMismatches );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Flop and turn hands, directly and on a prepared board.
+void checkFiveAndSixCardHands()
+{
+   FiveCardEvaluator evaluator;
+   FiveOfSevenCardEvaluator fiveOfSevenEvaluator;
+   CardDeck deck( FULL_DECK, SELF_CHECK_SEED, 14 );
+
+   std::size_t mismatches = 0;
+   std::size_t preparedBoardMismatches = 0;
+   for( unsigned int i = 0; i < RANDOM_HANDS; ++i ) {
+      CardSet holeCards = deck.dealCards( 2 );
+      CardSet commonCards = deck.dealCards( 3 + i % 2 );
+      deck.clean();
+      unsigned int value = evaluator.evaluate( holeCards | commonCards );
+      mismatches += fiveOfSevenEvaluator.evaluate( holeCards | commonCards ) != value;
+      preparedBoardMismatches +=
+         fiveOfSevenEvaluator.evaluateHoldemHand( fiveOfSevenEvaluator.prepareBoard( commonCards ), holeCards ) != value;
+   }
+
+   report( "five and six cards, FiveOfSevenCardEvaluator", mismatches );
+   report( "five and six cards, PreparedBoard", preparedBoardMismatches );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+void checkSuitMaskHands()
+{
+   FiveCardEvaluator evaluator;
+   SuitMaskEvaluator suitMaskEvaluator;
+   CardDeck deck( FULL_DECK, SELF_CHECK_SEED, 13 );
+
+   std::size_t mismatches = 0;
+   for( unsigned int i = 0; i < RANDOM_HANDS; ++i ) {
+      CardSet holeCards = deck.dealCards( 2 );
+      CardSet commonCards = deck.dealCards( 3 + i % 3 );
+      deck.clean();
+      mismatches += suitMaskEvaluator.evaluateHoldemHand( holeCards, commonCards ) != evaluator.evaluate( holeCards | commonCards );
+   }
+
+   report( "five to seven cards, SuitMaskEvaluator", mismatches );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// whether the showdown refuses the seats
+bool rejectsShowdown( const FiveOfSevenCardEvaluator& evaluator, const PreparedBoard& board,
+                      const CardSet holeCards[], unsigned int numberOfSeats )
+{
+   try {
+      evaluator.showdown( board, holeCards, numberOfSeats );
+   }
+   catch( std::logic_error& ) {
+      return true;
+   }
+   return false;
+}
+
+// settle() on fixed values, then showdowns of random deals against
+// FiveCardEvaluator and a board that splits the pot three ways.
+void checkShowdowns()
+{
+   std::size_t settleMismatches = 0;
+   ShowdownResult result;
+   const unsigned short twoWaySplit[] = { 5, 3, 3 };
+   std::copy( twoWaySplit, twoWaySplit + 3, result.values );
+   result.settle( 3 );
+   settleMismatches += result.winners != 0x6 || result.numberOfWinners != 2;
+   settleMismatches += result.shares[ 0 ] != 0.0f || result.shares[ 1 ] != 0.5f || result.shares[ 2 ] != 0.5f;
+
+   const unsigned short threeWaySplit[] = { 7, 7, 9, 7 };
+   std::copy( threeWaySplit, threeWaySplit + 4, result.values );
+   result.settle( 4 );
+   settleMismatches += result.winners != 0xb || result.numberOfWinners != 3;
+   settleMismatches += result.shares[ 0 ] != 1.0f / 3 || result.shares[ 2 ] != 0.0f || result.shares[ 3 ] != 1.0f / 3;
+
+   const unsigned short higherIsBetter[] = { 2, 5, 5, 1 };
+   std::copy( higherIsBetter, higherIsBetter + 4, result.values );
+   result.settle( 4, false );
+   settleMismatches += result.winners != 0x6 || result.shares[ 1 ] != 0.5f || result.shares[ 3 ] != 0.0f;
+   report( "showdown settle", settleMismatches );
+
+   FiveCardEvaluator fiveCardEvaluator;
+   FiveOfSevenCardEvaluator evaluator;
+   CardDeck deck( FULL_DECK, SELF_CHECK_SEED, 15 );
+   std::size_t mismatches = 0;
+   for( unsigned int i = 0; i < RANDOM_HANDS / 10; ++i ) {
+      unsigned int numberOfSeats = 1 + i % MAX_SEATS;
+      CardSet commonCards = deck.dealCards( 5 );
+      PreparedBoard board = evaluator.prepareBoard( commonCards );
+      CardSet holeCards[ MAX_SEATS ];
+      for( unsigned int seat = 0; seat < numberOfSeats; ++seat ) {
+         holeCards[ seat ] = deck.dealCards( 2 );
+      }
+      deck.clean();
+
+      ShowdownResult showdown = evaluator.showdown( board, holeCards, numberOfSeats );
+      unsigned int bestValue = 9999;
+      float shareSum = 0.0f;
+      for( unsigned int seat = 0; seat < numberOfSeats; ++seat ) {
+         unsigned int value = fiveCardEvaluator.evaluate( commonCards | holeCards[ seat ] );
+         mismatches += showdown.values[ seat ] != value;
+         bestValue = std::min( bestValue, value );
+         shareSum += showdown.shares[ seat ];
+      }
+      for( unsigned int seat = 0; seat < numberOfSeats; ++seat ) {
+         mismatches += ( ( showdown.winners >> seat ) & 1 ) != ( showdown.values[ seat ] == bestValue );
+      }
+      mismatches += shareSum < 0.9999f || shareSum > 1.0001f;
+   }
+
+   // everybody plays the broadway straight on the board
+   CardSet broadway;
+   broadway.add( Card( ACE, HEART ).index() );
+   broadway.add( Card( KING, DIAMOND ).index() );
+   broadway.add( Card( QUEEN, CLUB ).index() );
+   broadway.add( Card( JACK, SPADE ).index() );
+   broadway.add( Card( TEN, HEART ).index() );
+   CardSet holeCards[ 3 ];
+   for( unsigned int seat = 0; seat < 3; ++seat ) {
+      holeCards[ seat ].add( Card( CardRank( DEUCE + 2 * seat ), CLUB ).index() );
+      holeCards[ seat ].add( Card( CardRank( TREY + 2 * seat ), DIAMOND ).index() );
+   }
+   ShowdownResult split = evaluator.showdown( evaluator.prepareBoard( broadway ), holeCards, 3 );
+   mismatches += split.winners != 0x7 || split.numberOfWinners != 3 || split.shares[ 1 ] != 1.0f / 3;
+   report( "showdowns", mismatches );
+
+   // a seat with no card, one card, a card on the board or a card of another seat
+   std::size_t accepted = 0;
+   PreparedBoard board = evaluator.prepareBoard( broadway );
+   CardSet badSeats[ 2 ] = { holeCards[ 0 ], CardSet() };
+   accepted += !rejectsShowdown( evaluator, board, badSeats, 2 );
+   badSeats[ 1 ].add( Card( NINE, SPADE ).index() );
+   accepted += !rejectsShowdown( evaluator, board, badSeats, 2 );
+   badSeats[ 1 ].add( Card( ACE, HEART ).index() );
+   accepted += !rejectsShowdown( evaluator, board, badSeats, 2 );
+   badSeats[ 1 ] = holeCards[ 0 ];
+   accepted += !rejectsShowdown( evaluator, board, badSeats, 2 );
+   report( "showdowns, bad hole cards refused", accepted );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// whether best is made of five cards of hand and valued as such
+bool isBestHandOf( const FiveCardEvaluator& evaluator, const BestHand& best, CardSet hand )
+{
+   return best.cards.size() == 5 && !( best.cards.mask() & ~hand.mask() ) && evaluator.evaluate( best.cards ) == best.value;
+}
+
+// The five cards picked by the best hand functions, on Hold'em and Omaha hands.
+void checkBestHands()
+{
+   FiveCardEvaluator evaluator;
+   FiveOfSevenCardEvaluator fiveOfSevenEvaluator;
+   OmahaEvaluator omahaEvaluator;
+   CardDeck deck( FULL_DECK, SELF_CHECK_SEED, 16 );
+
+   std::size_t holdemMismatches = 0;
+   std::size_t omahaMismatches = 0;
+   for( unsigned int i = 0; i < RANDOM_HANDS / 4; ++i ) {
+      CardSet holeCards = deck.dealCards( 2 );
+      CardSet commonCards = deck.dealCards( 3 + i % 3 );
+      deck.clean();
+      CardSet hand = holeCards | commonCards;
+      unsigned int value = evaluator.evaluate( hand );
+
+      BestHand best = evaluator.evaluateBestHand( hand );
+      holdemMismatches += !isBestHandOf( evaluator, best, hand ) || best.value != value;
+      best = fiveOfSevenEvaluator.evaluateBestHand( hand );
+      holdemMismatches += !isBestHandOf( evaluator, best, hand ) || best.value != value;
+      best = fiveOfSevenEvaluator.evaluateBestHoldemHand( fiveOfSevenEvaluator.prepareBoard( commonCards ), holeCards );
+      holdemMismatches += !isBestHandOf( evaluator, best, hand ) || best.value != value;
+
+      // two hole cards and three common cards
+      unsigned int numberOfHoleCards = 4 + i % 3;
+      CardSet omahaHoleCards = deck.dealCards( numberOfHoleCards );
+      CardSet board = deck.dealCards( 5 );
+      deck.clean();
+      unsigned int hole[ MAX_OMAHA_HOLE_CARDS ];
+      unsigned int common[ 5 ];
+      toRawCards( omahaHoleCards, hole );
+      toRawCards( board, common );
+      unsigned int omahaValue = evaluator.evaluateOmahaHand( omahaHoleCards.toHand(), board.toHand() );
+      const BestHand omahaBest[] = { evaluator.evaluateBestOmahaHand( omahaHoleCards.toHand(), board.toHand() ),
+                                     omahaEvaluator.evaluateBestHand( hole, common, numberOfHoleCards ) };
+      for( const BestHand& b : omahaBest ) {
+         omahaMismatches += !isBestHandOf( evaluator, b, omahaHoleCards | board ) || b.value != omahaValue;
+         omahaMismatches += CardSet( b.cards.mask() & omahaHoleCards.mask() ).size() != 2;
+      }
+   }
+
+   report( "best five cards, Hold'em", holdemMismatches );
+   report( "best five cards, Omaha", omahaMismatches );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+struct DecodedBoundary {
+   unsigned int value;
+   HandRank handRank;
+   std::vector< CardRank > primaryRanks;
+   std::vector< CardRank > kickers;
+   const char* name;
+};
+
+// decode() and handRankName() at the ends of the hand ranks, countHandRanks()
+// against a plain loop on lengths which are not all a multiple of 4.
+void checkDecodedHands()
+{
+   const DecodedBoundary boundaries[] = {
+      { 1, STRAIGHT_FLUSH, { ACE }, {}, "Straight Flush" },
+      { 10, STRAIGHT_FLUSH, { FIVE }, {}, "Straight Flush" },
+      { 166, FOUR_OF_A_KIND, { DEUCE }, { TREY }, "Four Of a Kind" },
+      { 167, FULL_HOUSE, { ACE, KING }, {}, "Full House" },
+      { 1609, STRAIGHT, { FIVE }, {}, "Straight" },
+      { 2467, THREE_OF_A_KIND, { DEUCE }, { FOUR, TREY }, "Set" },
+      { 3325, TWO_PAIR, { TREY, DEUCE }, { FOUR }, "Two Pairs" },
+      { 7462, HIGH_CARD, { SEVEN }, { FIVE, FOUR, TREY, DEUCE }, "High Card" }
+   };
+
+   std::size_t mismatches = 0;
+   for( const DecodedBoundary& boundary : boundaries ) {
+      DecodedHand decoded = FiveCardEvaluator::decode( boundary.value );
+      mismatches += decoded.handRank != boundary.handRank || FiveCardEvaluator::handRankName( boundary.value ) != boundary.name;
+      mismatches += decoded.numberOfPrimaryRanks != boundary.primaryRanks.size() || decoded.numberOfKickers != boundary.kickers.size();
+      for( unsigned int i = 0; i < decoded.numberOfPrimaryRanks && i < boundary.primaryRanks.size(); ++i ) {
+         mismatches += decoded.primaryRanks[ i ] != boundary.primaryRanks[ i ];
+      }
+      for( unsigned int i = 0; i < decoded.numberOfKickers && i < boundary.kickers.size(); ++i ) {
+         mismatches += decoded.kickers[ i ] != boundary.kickers[ i ];
+      }
+   }
+   report( "decoded hands", mismatches );
+
+   RandomStream stream( SELF_CHECK_SEED, 17 );
+   std::size_t histogramMismatches = 0;
+   for( std::size_t numberOfValues : { 0, 1, 2, 3, 5, 7, 4096, 10007 } ) {
+      std::vector< unsigned short > values( numberOfValues );
+      std::size_t expected[ NUMBER_OF_HAND_RANKS ] = { 0 };
+      for( unsigned short& value : values ) {
+         value = 1 + stream.next32() % NUMBER_OF_HAND_VALUES;
+         ++expected[ FiveCardEvaluator::handRank( value ) ];
+      }
+      std::size_t histogram[ NUMBER_OF_HAND_RANKS ] = { 0 };
+      FiveCardEvaluator::countHandRanks( values.data(), numberOfValues, histogram );
+      for( unsigned int i = 0; i < NUMBER_OF_HAND_RANKS; ++i ) {
+         histogramMismatches += histogram[ i ] != expected[ i ];
+      }
+   }
+   report( "hand rank histogram", histogramMismatches );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Six and seven cards against their best five card subset, then hands whose
+// order differs from the full deck.
+void checkShortDeck()
+{
+   ShortDeckEvaluator evaluator;
+   CardDeck deck( SHORT_DECK, SELF_CHECK_SEED, 5 );
+
+   std::size_t mismatches = 0;
+   for( unsigned int i = 0; i < RANDOM_HANDS; ++i ) {
+      unsigned int numberOfCards = 6 + i % 2;
+      unsigned int rawCards[ 7 ];
+      toRawCards( deck.dealCards( numberOfCards ), rawCards );
+      deck.clean();
+      unsigned int best = bestFiveCardSubset( rawCards, numberOfCards,
+                                              [ & ]( const unsigned int subset[] ) { return evaluator.evaluate( subset, 5 ); } );
+      mismatches += evaluator.evaluate( rawCards, numberOfCards ) != best;
+   }
+   report( "short deck, six and seven cards", mismatches );
+
+   unsigned int royalFlush = evaluator.evaluate( CardSet( Hand{ Card( ACE, SPADE ), Card( KING, SPADE ), Card( QUEEN, SPADE ),
+                                                                Card( JACK, SPADE ), Card( TEN, SPADE ) } ) );
+   unsigned int worstHand = evaluator.evaluate( CardSet( Hand{ Card( JACK, CLUB ), Card( NINE, DIAMOND ), Card( EIGHT, HEART ),
+                                                               Card( SEVEN, SPADE ), Card( SIX, CLUB ) } ) );
+   unsigned int flush = evaluator.evaluate( CardSet( Hand{ Card( KING, HEART ), Card( JACK, HEART ), Card( NINE, HEART ),
+                                                           Card( EIGHT, HEART ), Card( SIX, HEART ) } ) );
+   unsigned int fullHouse = evaluator.evaluate( CardSet( Hand{ Card( ACE, CLUB ), Card( ACE, DIAMOND ), Card( ACE, HEART ),
+                                                               Card( KING, CLUB ), Card( KING, SPADE ) } ) );
+   unsigned int aceToNine = evaluator.evaluate( CardSet( Hand{ Card( ACE, CLUB ), Card( NINE, DIAMOND ), Card( EIGHT, HEART ),
+                                                               Card( SEVEN, SPADE ), Card( SIX, CLUB ) } ) );
+   unsigned int sixToTen = evaluator.evaluate( CardSet( Hand{ Card( TEN, CLUB ), Card( NINE, DIAMOND ), Card( EIGHT, HEART ),
+                                                              Card( SEVEN, SPADE ), Card( SIX, CLUB ) } ) );
+
+   std::size_t fixedMismatches = 0;
+   fixedMismatches += royalFlush != 1 || worstHand != NUMBER_OF_SHORT_DECK_VALUES;
+   fixedMismatches += !( flush < fullHouse );
+   fixedMismatches += aceToNine != sixToTen + 1 || ShortDeckEvaluator::handRank( aceToNine ) != STRAIGHT;
+   report( "short deck, fixed hands", fixedMismatches );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+void checkLowball()
+{
+   LowballEvaluator evaluator;
+   CardDeck deck( FULL_DECK, SELF_CHECK_SEED, 6 );
+
+   std::size_t aceToFiveMismatches = 0;
+   for( unsigned int i = 0; i < RANDOM_HANDS; ++i ) {
+      CardSet hand = deck.dealCards( 7 );
+      deck.clean();
+      unsigned int rawCards[ 7 ];
+      toRawCards( hand, rawCards );
+      unsigned int best = bestFiveCardSubset( rawCards, 7, []( const unsigned int subset[] ) {
+         return LowballEvaluator::evaluateAceToFive( subset[ 0 ], subset[ 1 ], subset[ 2 ], subset[ 3 ], subset[ 4 ] );
+      } );
+      aceToFiveMismatches += LowballEvaluator::evaluateAceToFive( rawCards, 7 ) != best;
+   }
+   report( "ace to five, seven cards", aceToFiveMismatches );
+
+   // deuce to seven: the ace is high only, 5-4-3-2-A is no straight
+   auto raw = []( CardRank rank, unsigned int suit ) { return Card::rawCard( rank * 4 + suit ); };
+   auto deuceToSeven = [ & ]( CardRank r1, CardRank r2, CardRank r3, CardRank r4, CardRank r5, bool suited ) {
+      return evaluator.evaluateDeuceToSeven( raw( r1, 0 ), raw( r2, suited ? 0 : 1 ), raw( r3, 0 ), raw( r4, 0 ), raw( r5, 0 ) );
+   };
+   std::size_t deuceToSevenMismatches = 0;
+   deuceToSevenMismatches += deuceToSeven( SEVEN, FIVE, FOUR, TREY, DEUCE, false ) != 1;
+   deuceToSevenMismatches += deuceToSeven( ACE, FIVE, FOUR, TREY, DEUCE, false ) != 785;
+   deuceToSevenMismatches += deuceToSeven( ACE, SIX, FOUR, TREY, DEUCE, false ) != 786;
+   deuceToSevenMismatches += deuceToSeven( ACE, FIVE, FOUR, TREY, DEUCE, true ) != 6648;
+   deuceToSevenMismatches += deuceToSeven( ACE, SIX, FOUR, TREY, DEUCE, true ) != 6649;
+   deuceToSevenMismatches += deuceToSeven( ACE, FIVE, FOUR, TREY, DEUCE, false )
+      >= deuceToSeven( SIX, FIVE, FOUR, TREY, DEUCE, false );
+
+   std::vector< unsigned int > valueCounts( NUMBER_OF_HAND_VALUES + 1 );
+   for( unsigned int value = 1; value <= NUMBER_OF_HAND_VALUES; ++value ) {
+      ++valueCounts[ lowballTables.deuceToSeven[ value ] ];
+   }
+   deuceToSevenMismatches += std::count( valueCounts.begin() + 1, valueCounts.end(), 1 ) != NUMBER_OF_HAND_VALUES;
+   report( "deuce to seven wheels", deuceToSevenMismatches );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// The eight or better low of Omaha Hi/Lo against all 60 combinations of two hole
+// cards and three common cards, NO_LOW counting as worst.
+void checkOmahaHiLo()
+{
+   FiveCardEvaluator evaluator;
+   OmahaEvaluator omahaEvaluator;
+   CardDeck deck( FULL_DECK, SELF_CHECK_SEED, 18 );
+
+   std::size_t highMismatches = 0;
+   std::size_t lowMismatches = 0;
+   for( unsigned int i = 0; i < RANDOM_HANDS / 4; ++i ) {
+      unsigned int numberOfHoleCards = 4 + i % 3;
+      CardSet holeCards = deck.dealCards( numberOfHoleCards );
+      CardSet commonCards = deck.dealCards( 5 );
+      deck.clean();
+
+      unsigned int hole[ MAX_OMAHA_HOLE_CARDS ];
+      unsigned int common[ 5 ];
+      toRawCards( holeCards, hole );
+      toRawCards( commonCards, common );
+      HiLoValues values = omahaEvaluator.evaluateHiLo( hole, common, numberOfHoleCards );
+      highMismatches += evaluator.evaluateOmahaHand( holeCards.toHand(), commonCards.toHand() ) != values.high;
+
+      unsigned int bestLow = NO_LOW;
+      for( unsigned int h1 = 0; h1 < numberOfHoleCards; ++h1 ) {
+         for( unsigned int h2 = h1 + 1; h2 < numberOfHoleCards; ++h2 ) {
+            for( unsigned int c1 = 0; c1 < 5; ++c1 ) {
+               for( unsigned int c2 = c1 + 1; c2 < 5; ++c2 ) {
+                  for( unsigned int c3 = c2 + 1; c3 < 5; ++c3 ) {
+                     unsigned int low = LowballEvaluator::evaluateEightOrBetter( hole[ h1 ], hole[ h2 ], common[ c1 ],
+                                                                                common[ c2 ], common[ c3 ] );
+                     if( low != NO_LOW && ( bestLow == NO_LOW || low < bestLow ) ) {
+                        bestLow = low;
+                     }
+                  }
+               }
+            }
+         }
+      }
+      lowMismatches += values.low != bestLow;
+   }
+
+   report( "Omaha Hi/Lo, high", highMismatches );
+   report( "Omaha Hi/Lo, eight or better low", lowMismatches );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Razz against the best five card ace to five low, eight and seven seats dealt
+// street by street, and equities from the same deals.
+void checkStud()
+{
+   StudEvaluator studEvaluator;
+   CardDeck deck( FULL_DECK, SELF_CHECK_SEED, 19 );
+
+   std::size_t razzMismatches = 0;
+   for( unsigned int i = 0; i < RANDOM_HANDS; ++i ) {
+      unsigned int numberOfCards = 5 + i % 3;
+      CardSet hand = deck.dealCards( numberOfCards );
+      deck.clean();
+      unsigned int rawCards[ 7 ];
+      toRawCards( hand, rawCards );
+      unsigned int best = bestFiveCardSubset( rawCards, numberOfCards, []( const unsigned int subset[] ) {
+         return LowballEvaluator::evaluateAceToFive( subset[ 0 ], subset[ 1 ], subset[ 2 ], subset[ 3 ], subset[ 4 ] );
+      } );
+      razzMismatches += StudEvaluator::evaluateRazz( hand ) != best;
+      razzMismatches += studEvaluator.evaluate( RAZZ, hand ) != best;
+   }
+   report( "Razz, five to seven cards", razzMismatches );
+
+   // seven seats take 49 cards of their own, eight seats 48 and one community card
+   // on seventh street as their last up card
+   std::size_t dealMismatches = 0;
+   for( unsigned int i = 0; i < RANDOM_HANDS / 100; ++i ) {
+      unsigned int numberOfSeats = MAX_STUD_SEATS - i % 2;
+      StudHand seats[ MAX_STUD_SEATS ];
+      for( unsigned int street = 3; street <= STUD_CARDS; ++street ) {
+         StudEvaluator::dealStreet( deck, seats, numberOfSeats );
+      }
+      deck.clean();
+
+      CardSet allCards;
+      std::uint64_t sharedUpCards = ~0ULL;
+      for( unsigned int seat = 0; seat < numberOfSeats; ++seat ) {
+         unsigned int downCards = numberOfSeats == MAX_STUD_SEATS ? 2 : 3;
+         dealMismatches += seats[ seat ].downCards.size() != downCards;
+         dealMismatches += seats[ seat ].upCards.size() != STUD_CARDS - downCards;
+         allCards |= seats[ seat ].cards();
+         sharedUpCards &= seats[ seat ].upCards.mask();
+      }
+      dealMismatches += allCards.size() != 49;
+      dealMismatches += CardSet( sharedUpCards ).size() != ( numberOfSeats == MAX_STUD_SEATS ? 1u : 0u );
+   }
+   report( "stud streets, seven and eight seats", dealMismatches );
+
+   // eight seats on fifth street with three dead cards: the equities add up to one
+   // and the caller's deck keeps its cards
+   std::size_t equityMismatches = 0;
+   for( unsigned int i = 0; i < 100; ++i ) {
+      StudHand seats[ MAX_STUD_SEATS ];
+      for( unsigned int street = 3; street <= 5; ++street ) {
+         StudEvaluator::dealStreet( deck, seats, MAX_STUD_SEATS );
+      }
+      CardSet deadCards = deck.dealCards( 3 );
+      CardSet remainingCards = deck.remainingCards();
+
+      double equities[ MAX_STUD_SEATS ];
+      studEvaluator.equity( i % 2 ? RAZZ : SEVEN_CARD_STUD, seats, MAX_STUD_SEATS, deadCards, 100, deck, equities );
+      equityMismatches += deck.remainingCards() != remainingCards;
+      deck.clean();
+
+      double sum = 0.0;
+      for( unsigned int seat = 0; seat < MAX_STUD_SEATS; ++seat ) {
+         sum += equities[ seat ];
+      }
+      equityMismatches += sum < 1.0 - 1e-9 || sum > 1.0 + 1e-9;
+   }
+
+   // Razz with every card dead but the aces: the six card 5-4-3-2 always catches an
+   // ace for the wheel and beats the complete ten low, any other card would lose
+   StudHand seats[ 2 ];
+   for( CardRank rank : { SIX, SEVEN, EIGHT, NINE, TEN, JACK, QUEEN } ) {
+      seats[ 0 ].upCards.add( Card( rank, CLUB ) );
+   }
+   for( const Card& card : { Card( DEUCE, DIAMOND ), Card( TREY, DIAMOND ), Card( FOUR, DIAMOND ),
+                             Card( FIVE, DIAMOND ), Card( KING, DIAMOND ), Card( KING, HEART ) } ) {
+      seats[ 1 ].upCards.add( card );
+   }
+   CardSet deadCards;
+   for( unsigned int index = 0; index < CARDS_IN_DECK; ++index ) {
+      if( index / 4 != ACE && !seats[ 0 ].cards().contains( index ) && !seats[ 1 ].cards().contains( index ) ) {
+         deadCards.add( index );
+      }
+   }
+   double equities[ 2 ];
+   studEvaluator.equity( RAZZ, seats, 2, deadCards, 1000, deck, equities );
+   equityMismatches += equities[ 0 ] != 0.0 || equities[ 1 ] != 1.0;
+   report( "stud equity", equityMismatches );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// A stream replays from its master seed and stream id, while the next stream id
+// or swapping the two gives another stream. Decks dealing from a stream, and the
+// decks split off them, deal the same cards on a replay.
+void checkRandomStreams()
+{
+   RandomStream stream( SELF_CHECK_SEED, 20 );
+   RandomStream replay( SELF_CHECK_SEED, 20 );
+   RandomStream nextStream( SELF_CHECK_SEED, 21 );
+   std::size_t streamMismatches = 0;
+   for( unsigned int i = 0; i < 1000; ++i ) {
+      std::uint64_t x = stream();
+      streamMismatches += x != replay();
+      streamMismatches += x == nextStream();
+   }
+   streamMismatches += RandomStream( 1, 2 )() == RandomStream( 2, 1 )();
+   streamMismatches += RandomStream( 7, 0 )() == RandomStream( 0, 7 )();
+   streamMismatches += RandomStream( 0, 0 )() == RandomStream( 0, 1 )();
+   report( "random streams", streamMismatches );
+
+   CardDeck deck( FULL_DECK, SELF_CHECK_SEED, 20 );
+   CardDeck replayDeck( FULL_DECK, SELF_CHECK_SEED, 20 );
+   std::size_t deckMismatches = 0;
+   for( unsigned int i = 0; i < 1000; ++i ) {
+      CardDeck trialDeck = deck.split();
+      CardDeck replayTrialDeck = replayDeck.split();
+      deckMismatches += deck.dealCards( 7 ) != replayDeck.dealCards( 7 );
+      deckMismatches += trialDeck.dealCards( 7 ) != replayTrialDeck.dealCards( 7 );
+      deck.clean();
+      replayDeck.clean();
+   }
+   report( "random streams, replayed decks", deckMismatches );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Draws of the board sampler are five different live cards, every live card comes
+// up about equally often, and a master seed gives the same draws on every kernel.
+void checkBoardSampler()
+{
+   CardSet deadCards;
+   for( unsigned int cardIndex : { 0u, 17u, 34u, 51u } ) {
+      deadCards.add( cardIndex );
+   }
+   BoardSampler sampler( deadCards, SELF_CHECK_SEED, 9 );
+
+   const std::size_t numberOfDraws = 10003;
+   std::vector< unsigned int > rawCards( 5 * numberOfDraws );
+   sampler.sample( 5, numberOfDraws, rawCards.data() );
+   std::size_t samplerMismatches = 0;
+   std::size_t cardCounts[ CARDS_IN_DECK ] = { 0 };
+   std::uint64_t checksum = 0;
+   for( std::size_t i = 0; i < numberOfDraws; ++i ) {
+      CardSet board;
+      for( unsigned int c = 0; c < 5; ++c ) {
+         unsigned int cardIndex = Card::cardIndex( rawCards[ c * numberOfDraws + i ] );
+         board.add( cardIndex );
+         ++cardCounts[ cardIndex ];
+         checksum = checksum * 31 + cardIndex;
+      }
+      samplerMismatches += board.size() != 5 || board.intersects( deadCards );
+   }
+   report( "board sampler", samplerMismatches );
+
+   // 5 * 10003 / 48 = 1042 draws per live card, the standard deviation is about 31
+   std::size_t frequencyMismatches = 0;
+   for( unsigned int cardIndex = 0; cardIndex < CARDS_IN_DECK; ++cardIndex ) {
+      if( !deadCards.contains( cardIndex ) ) {
+         frequencyMismatches += cardCounts[ cardIndex ] < 900 || cardCounts[ cardIndex ] > 1200;
+      }
+   }
+   report( "board sampler, card frequencies", frequencyMismatches );
+
+   // the draws of the scalar kernel, the AVX2 kernel steps its lanes identically
+   report( "board sampler, same draws on every kernel", checksum != 13992464315101702467ULL );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Every combination of four of the 45 cards left after seven are dealt is stepped
+// through in index order, ranks back to its index and unranks to the same cards.
+// Then the boards of a heads-up matchup are split into work units.
+void checkCombinationIndex()
+{
+   CardDeck deck( FULL_DECK, SELF_CHECK_SEED, 8 );
+   deck.dealCards( 7 );
+   CombinationIndex index( deck, 4 );
+
+   std::size_t mismatches = 0;
+   CombinationIterator combination( index, 0 );
+   for( std::uint64_t i = 0; i < index.size(); ++i ) {
+      mismatches += combination.cards().size() != 4 || combination.cards().intersects( CardSet( ~index.deck().mask() ) );
+      mismatches += index.rank( combination.cards() ) != i;
+      if( i % 97 == 0 ) {
+         mismatches += index.unrank( i ) != combination.cards();
+      }
+      if( i + 1 < index.size() ) {
+         combination.next();
+      }
+   }
+   mismatches += index.size() != 148995;
+   report( "combination index", mismatches );
+
+   // the units cover the 1,712,304 boards without gaps, differ by at most one board,
+   // and an iterator started at a unit's first index goes on into the next unit
+   deck.clean();
+   deck.dealCards( 4 );
+   CombinationIndex boards( deck, 5 );
+   std::size_t splitMismatches = boards.size() != 1712304;
+   const unsigned int numberOfUnits = 7;
+   splitMismatches += boards.splitPoint( 0, numberOfUnits ) != 0;
+   splitMismatches += boards.splitPoint( numberOfUnits, numberOfUnits ) != boards.size();
+   for( unsigned int unit = 0; unit < numberOfUnits; ++unit ) {
+      std::uint64_t first = boards.splitPoint( unit, numberOfUnits );
+      std::uint64_t end = boards.splitPoint( unit + 1, numberOfUnits );
+      splitMismatches += end - first < boards.size() / numberOfUnits || end - first > boards.size() / numberOfUnits + 1;
+
+      CombinationIterator board( boards, first );
+      for( std::uint64_t i = first; i + 1 < end; ++i ) {
+         board.next();
+      }
+      if( end < boards.size() ) {
+         board.next();
+         splitMismatches += board.cards() != boards.unrank( end ) || board.index() != end;
+      }
+   }
+   report( "combination index, work units", splitMismatches );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// every board played out one by one on the prepared board
+EquityCounts bruteForceEquity( const FiveOfSevenCardEvaluator& evaluator, CardSet holeCards1, CardSet holeCards2,
+                               CardSet commonCards, CardSet liveCards )
+{
+   EquityCounts counts = { 0, 0, 0 };
+   CombinationIndex index( liveCards, 5 - commonCards.size() );
+   CombinationIterator combination( index, 0 );
+   for( std::uint64_t board = 0; board < index.size(); ++board ) {
+      PreparedBoard preparedBoard = evaluator.prepareBoard( commonCards | combination.cards() );
+      unsigned int value1 = evaluator.evaluateHoldemHand( preparedBoard, holeCards1 );
+      unsigned int value2 = evaluator.evaluateHoldemHand( preparedBoard, holeCards2 );
+      counts.wins += value1 < value2;
+      counts.ties += value1 == value2;
+      counts.losses += value1 > value2;
+      if( board + 1 < index.size() ) {
+         combination.next();
+      }
+   }
+   return counts;
+}
+
+bool operator!=( const EquityCounts& a, const EquityCounts& b )
+{
+   return a.wins != b.wins || a.ties != b.ties || a.losses != b.losses;
+}
+
+// The enumerator against brute force on flops and turns, on all 1,712,304 boards of
+// a preflop matchup, and split over several threads.
+void checkEquityEnumerator()
+{
+   FiveOfSevenCardEvaluator evaluator;
+   EquityEnumerator enumerator;
+   CardDeck deck( FULL_DECK, SELF_CHECK_SEED, 7 );
+
+   std::size_t mismatches = 0;
+   for( unsigned int i = 0; i < 40; ++i ) {
+      CardSet holeCards1 = deck.dealCards( 2 );
+      CardSet holeCards2 = deck.dealCards( 2 );
+      CardSet commonCards = deck.dealCards( 3 + i % 2 );
+      CardSet liveCards = deck.remainingCards();
+      deck.clean();
+
+      mismatches += enumerator.enumerate( holeCards1, holeCards2, commonCards )
+                    != bruteForceEquity( evaluator, holeCards1, holeCards2, commonCards, liveCards );
+   }
+   report( "exact equity on flop and turn", mismatches );
+
+   CardSet holeCards1 = deck.dealCards( 2 );
+   CardSet holeCards2 = deck.dealCards( 2 );
+   CardSet liveCards = deck.remainingCards();
+   deck.clean();
+   EquityCounts counts = enumerator.enumerate( holeCards1, holeCards2 );
+   std::size_t preflopMismatches = counts.boards() != 1712304;
+   preflopMismatches += counts != bruteForceEquity( evaluator, holeCards1, holeCards2, CardSet(), liveCards );
+   report( "exact equity preflop", preflopMismatches );
+
+   // the units taken by the threads in any order add up to the same counts
+   std::size_t threadMismatches = 0;
+   threadMismatches += enumerator.enumerate( holeCards1, holeCards2, CardSet(), 4 ) != counts;
+   threadMismatches += enumerator.enumerate( holeCards1, holeCards2, CardSet(), 0 ) != counts;
+   for( unsigned int i = 0; i < 10; ++i ) {
+      CardSet holeCards1 = deck.dealCards( 2 );
+      CardSet holeCards2 = deck.dealCards( 2 );
+      CardSet commonCards = deck.dealCards( 3 * ( i % 2 ) );
+      deck.clean();
+      threadMismatches += enumerator.enumerate( holeCards1, holeCards2, commonCards, 3 )
+                          != enumerator.enumerate( holeCards1, holeCards2, commonCards, 1 );
+   }
+   report( "exact equity, several threads", threadMismatches );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Locked cards stay out of the deck after clean() and come back with cleanAll(),
+// a short deck never deals the deuces to fives, the bulk deal stops when the deck
+// runs out, and every card is dealt about equally often.
+void checkCardDeck()
+{
+   CardDeck deck( FULL_DECK, SELF_CHECK_SEED, 22 );
+   CardSet lockedCards;
+   for( unsigned int cardIndex : { 3u, 25u, 48u } ) {
+      deck.lockCard( cardIndex );
+      lockedCards.add( cardIndex );
+   }
+
+   std::size_t mismatches = 0;
+   std::size_t cardCounts[ CARDS_IN_DECK ] = { 0 };
+   for( unsigned int i = 0; i < 10000; ++i ) {
+      unsigned int cardIndices[ CARDS_IN_DECK ];
+      unsigned int numberOfCards = deck.dealCards( 52, cardIndices );
+      mismatches += numberOfCards != CARDS_IN_DECK - 3 || deck.remainingCards().size() != 0;
+      CardSet dealtCards;
+      for( unsigned int c = 0; c < numberOfCards; ++c ) {
+         dealtCards.add( cardIndices[ c ] );
+      }
+      mismatches += dealtCards.size() != numberOfCards || dealtCards.intersects( lockedCards );
+      // the first card dealt of each deck
+      ++cardCounts[ cardIndices[ 0 ] ];
+      deck.clean();
+   }
+   // 10000 / 49 = 204 per live card, the standard deviation is about 14
+   for( unsigned int cardIndex = 0; cardIndex < CARDS_IN_DECK; ++cardIndex ) {
+      mismatches += lockedCards.contains( cardIndex ) ? cardCounts[ cardIndex ] != 0
+                                                      : cardCounts[ cardIndex ] < 140 || cardCounts[ cardIndex ] > 270;
+   }
+   deck.cleanAll();
+   mismatches += deck.remainingCards().size() != CARDS_IN_DECK;
+
+   CardDeck shortDeck( SHORT_DECK, SELF_CHECK_SEED, 23 );
+   for( unsigned int i = 0; i < 1000; ++i ) {
+      CardSet cards = shortDeck.dealCards( CARDS_IN_SHORT_DECK );
+      mismatches += cards.size() != CARDS_IN_SHORT_DECK || cards.mask() & ( ( 1ULL << SHORT_DECK_FIRST_CARD ) - 1 );
+      shortDeck.cleanAll();
+   }
+
+   report( "card deck, locks and dealing", mismatches );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// whether opening fileName as a lookup table is refused
+bool rejectsLookupTable( const std::string& fileName )
+{
+   try {
+      LookupTableEvaluator evaluator( fileName );
+   }
+   catch( std::runtime_error& ) {
+      return true;
+   }
+   return false;
+}
+
+// The table built by lookupTableGenerator into a temporary file, plus a copy with
+// a bad magic and one cut short, which must both be refused.
+void checkLookupTable( const std::string& fileName )
+{
+   LookupTableEvaluator lookupTableEvaluator( fileName );
+   FiveCardEvaluator evaluator;
+   CardDeck deck( FULL_DECK, SELF_CHECK_SEED, 10 );
+
+   std::size_t mismatches = 0;
+   for( unsigned int i = 0; i < RANDOM_HANDS; ++i ) {
+      unsigned int numberOfCards = 5 + i % 3;
+      unsigned int cardIndices[ 7 ] = { 0 };
+      CardSet hand = deck.dealCards( numberOfCards );
+      deck.clean();
+      hand.indices( cardIndices );
+      // the state machine must not depend on the order of the cards
+      std::swap( cardIndices[ 0 ], cardIndices[ i % numberOfCards ] );
+      mismatches += lookupTableEvaluator.evaluate( cardIndices, numberOfCards ) != evaluator.evaluate( hand );
+   }
+   report( "lookup table, five to seven cards", mismatches );
+
+   std::vector< char > start( sizeof( LookupTableHeader ) + 64 * LOOKUP_TABLE_ROW_SIZE * sizeof( std::uint32_t ) );
+   std::ifstream( fileName, std::ios::binary ).read( start.data(), start.size() );
+   std::ofstream( fileName + ".truncated", std::ios::binary ).write( start.data(), start.size() );
+   start[ 0 ] ^= 0x20;
+   std::ofstream( fileName + ".badMagic", std::ios::binary ).write( start.data(), start.size() );
+
+   std::size_t accepted = 0;
+   accepted += !rejectsLookupTable( fileName + ".truncated" );
+   accepted += !rejectsLookupTable( fileName + ".badMagic" );
+   accepted += !rejectsLookupTable( fileName + ".missing" );
+   report( "lookup table, broken files refused", accepted );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+int main( int argc, char * argv[] )
+{
+   std::cout << "Using " << instructionSetName( selectedInstructionSet() ) << " kernels" << std::endl;
+
+   try {
+      checkSevenCardHands();
+      checkOmahaHands();
+      checkBatchEvaluation();
+      checkShowdownBlocks();
+      checkHoldemHands();
+      checkRiverRankings();
+      checkFiveCardHands();
+      checkSuitMaskHands();
+      checkFiveAndSixCardHands();
+      checkShowdowns();
+      checkBestHands();
+      checkDecodedHands();
+      checkShortDeck();
+      checkLowball();
+      checkOmahaHiLo();
+      checkStud();
+      checkRandomStreams();
+      checkBoardSampler();
+      checkCombinationIndex();
+      checkEquityEnumerator();
+      checkCardDeck();
+      if( argc > 1 ) {
+         checkLookupTable( argv[ 1 ] );
+      }
+   }
+   catch( std::exception& e ) {
+      std::cout << "Exception: " << e.what() << std::endl;
+      return 1;
+   }
+
+   return failedChecks ? 1 : 0;
+}
@@ -0,0 +1,333 @@
+// Short deck (6+) Hold'em evaluator.
+//
+// The five card values are derived from FiveCardEvaluator: within a hand rank
+// the full deck values already order the hands, so the short deck value of a
+// hand is its position when sorting by the short deck hand rank order first and
+// the full deck value second. A-6-7-8-9 is a high card or a flush in the full
+// deck and is moved just below 10-9-8-7-6. Six and seven card tables take the
+// best hand left after removing one card, as in FiveOfSevenCardEvaluator.
+
+#include <stdexcept>
+#include <functional>
+#include <algorithm>
+#include <vector>
+
+#include "FiveCardEvaluator.h"
+#include "ShortDeckEvaluator.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+unsigned short ShortDeckEvaluator::flushes[ SHORT_DECK_FLUSH_TABLE_SIZE ];
+unsigned short ShortDeckEvaluator::ranks5[ SHORT_DECK_RANK_TABLE_SIZE_5 ];
+unsigned short ShortDeckEvaluator::ranks6[ SHORT_DECK_RANK_TABLE_SIZE_6 ];
+unsigned short ShortDeckEvaluator::ranks7[ SHORT_DECK_RANK_TABLE_SIZE_7 ];
+unsigned int ShortDeckEvaluator::quinaryOffsets[ SHORT_DECK_RANKS ][ 8 ][ 5 ];
+unsigned char ShortDeckEvaluator::handRanks[ NUMBER_OF_SHORT_DECK_VALUES + 1 ];
+std::once_flag ShortDeckEvaluator::tablesInitialized_;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+   const unsigned int SHORT_DECK_WHEEL = 0x10f;         // A-6-7-8-9 as short deck rank mask
+   const unsigned int SIX_HIGH_STRAIGHT = 0x1f << SIX;  // 10-9-8-7-6 as full deck rank mask
+
+   // position of each HandRank in the short deck order, best first
+   const unsigned int handRankOrder[ NUMBER_OF_HAND_RANKS ] = { 8, 7, 6, 5, 4, 2, 3, 1, 0 };
+   const HandRank handRanksInOrder[ NUMBER_OF_HAND_RANKS ] = {
+      STRAIGHT_FLUSH, FOUR_OF_A_KIND, FLUSH, FULL_HOUSE, STRAIGHT, THREE_OF_A_KIND, TWO_PAIR, ONE_PAIR, HIGH_CARD
+   };
+
+   void forEachRankMultiset( unsigned char rankCounts[], unsigned int rank, unsigned int cardsLeft,
+                             const std::function< void( const unsigned char[] ) >& callback )
+   {
+      if( rank == SHORT_DECK_RANKS ) {
+         if( cardsLeft == 0 ) {
+            callback( rankCounts );
+         }
+         return;
+      }
+
+      for( unsigned int count = 0; count <= 4 && count <= cardsLeft; ++count ) {
+         rankCounts[ rank ] = count;
+         forEachRankMultiset( rankCounts, rank + 1, cardsLeft - count, callback );
+      }
+      rankCounts[ rank ] = 0;
+   }
+
+   inline unsigned int rawCard( unsigned int shortDeckRank, unsigned int suit )
+   {
+      return Card::rawCard( ( ( shortDeckRank + SIX ) << 2 ) + suit );
+   }
+
+   // sorts five card hands into short deck order: hand rank first, full deck value second
+   unsigned int sortKey( const FiveCardEvaluator& evaluator, const unsigned int rawCards[ 5 ] )
+   {
+      unsigned int a = rawCards[ 0 ], b = rawCards[ 1 ], c = rawCards[ 2 ], d = rawCards[ 3 ], e = rawCards[ 4 ];
+      unsigned int value = evaluator.evaluate( a, b, c, d, e );
+      HandRank handRank = FiveCardEvaluator::handRank( value );
+      unsigned int position = 2 * value;
+
+      if( ( ( a | b | c | d | e ) >> ( 16 + SIX ) ) == SHORT_DECK_WHEEL ) {
+         bool flush = a & b & c & d & e & 0xf000;
+         handRank = flush ? STRAIGHT_FLUSH : STRAIGHT;
+         position = 2 * ( flush ? evaluator.evaluateFlush( SIX_HIGH_STRAIGHT )
+                                : evaluator.evaluateRanks( SIX_HIGH_STRAIGHT, 0 ) ) + 1;
+      }
+
+      return ( handRankOrder[ handRank ] << 16 ) | position;
+   }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int ShortDeckEvaluator::quinaryHash( const unsigned char rankCounts[], unsigned int numberOfCards )
+{
+  unsigned int hash = 0;
+  for( unsigned int rank = 0; rank < SHORT_DECK_RANKS && numberOfCards; ++rank ) {
+    hash += quinaryOffsets[ rank ][ numberOfCards ][ rankCounts[ rank ] ];
+    numberOfCards -= rankCounts[ rank ];
+  }
+
+  return hash;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+void ShortDeckEvaluator::generateTables()
+{
+  // sequences[ n ][ k ]: number of ways to spread k cards over n ranks, at most 4 per rank
+  unsigned int sequences[ SHORT_DECK_RANKS + 1 ][ 8 ] = { { 1 } };
+  for( unsigned int n = 1; n <= SHORT_DECK_RANKS; ++n ) {
+    for( unsigned int k = 0; k < 8; ++k ) {
+      for( unsigned int count = 0; count <= 4 && count <= k; ++count ) {
+        sequences[ n ][ k ] += sequences[ n - 1 ][ k - count ];
+      }
+    }
+  }
+
+  for( unsigned int rank = 0; rank < SHORT_DECK_RANKS; ++rank ) {
+    for( unsigned int k = 0; k < 8; ++k ) {
+      unsigned int offset = 0;
+      for( unsigned int count = 0; count < 5; ++count ) {
+        quinaryOffsets[ rank ][ k ][ count ] = offset;
+        if( count <= k ) {
+          offset += sequences[ SHORT_DECK_RANKS - 1 - rank ][ k - count ];
+        }
+      }
+    }
+  }
+
+  // Sort keys of all five card flushes, by rank mask, and of all other five
+  // card hands, by quinary hash, with suits dealt round robin so they never
+  // form a flush.
+  FiveCardEvaluator evaluator;
+  unsigned int flushKeys[ SHORT_DECK_FLUSH_TABLE_SIZE ] = { 0 };
+  unsigned int rankKeys[ SHORT_DECK_RANK_TABLE_SIZE_5 ] = { 0 };
+  std::vector< unsigned int > keys;
+
+  for( unsigned int mask = 0; mask < SHORT_DECK_FLUSH_TABLE_SIZE; ++mask ) {
+    if( __builtin_popcount( mask ) == 5 ) {
+      unsigned int rawCards[ 5 ];
+      unsigned int n = 0;
+      for( unsigned int rank = 0; rank < SHORT_DECK_RANKS; ++rank ) {
+        if( mask & ( 1 << rank ) ) {
+          rawCards[ n++ ] = rawCard( rank, SPADE );
+        }
+      }
+      flushKeys[ mask ] = sortKey( evaluator, rawCards );
+      keys.push_back( flushKeys[ mask ] );
+    }
+  }
+
+  unsigned char rankCounts[ SHORT_DECK_RANKS ] = { 0 };
+  forEachRankMultiset( rankCounts, 0, 5, [&]( const unsigned char counts[] ) {
+      unsigned int rawCards[ 5 ];
+      unsigned int n = 0;
+      for( unsigned int rank = 0; rank < SHORT_DECK_RANKS; ++rank ) {
+        for( unsigned int i = 0; i < counts[ rank ]; ++i, ++n ) {
+          rawCards[ n ] = rawCard( rank, n % 4 );
+        }
+      }
+      unsigned int hash = quinaryHash( counts, 5 );
+      rankKeys[ hash ] = sortKey( evaluator, rawCards );
+      keys.push_back( rankKeys[ hash ] );
+    } );
+
+  std::sort( keys.begin(), keys.end() );
+  if( std::unique( keys.begin(), keys.end() ) - keys.begin() != NUMBER_OF_SHORT_DECK_VALUES ) {
+    throw std::logic_error( "Short deck hand values are not unique." );
+  }
+
+  auto valueOf = [&]( unsigned int key ) {
+    unsigned int value = std::lower_bound( keys.begin(), keys.end(), key ) - keys.begin() + 1;
+    handRanks[ value ] = handRanksInOrder[ key >> 16 ];
+    return value;
+  };
+
+  for( unsigned int mask = 0; mask < SHORT_DECK_FLUSH_TABLE_SIZE; ++mask ) {
+    int bits = __builtin_popcount( mask );
+    if( bits < 5 ) {
+      flushes[ mask ] = 0;
+    }
+    else if( bits == 5 ) {
+      flushes[ mask ] = valueOf( flushKeys[ mask ] );
+    }
+    else {
+      unsigned short bestValue = 9999;
+      for( unsigned int rank = 0; rank < SHORT_DECK_RANKS; ++rank ) {
+        if( ( mask & ( 1 << rank ) ) && flushes[ mask & ~( 1 << rank ) ] < bestValue ) {
+          bestValue = flushes[ mask & ~( 1 << rank ) ];
+        }
+      }
+      flushes[ mask ] = bestValue;
+    }
+  }
+
+  for( unsigned int hash = 0; hash < SHORT_DECK_RANK_TABLE_SIZE_5; ++hash ) {
+    ranks5[ hash ] = valueOf( rankKeys[ hash ] );
+  }
+
+  auto reduce = []( const unsigned char counts[], unsigned int numberOfCards,
+                    const unsigned short smallerTable[] ) {
+    unsigned char smaller[ SHORT_DECK_RANKS ];
+    unsigned short bestValue = 9999;
+    for( unsigned int rank = 0; rank < SHORT_DECK_RANKS; ++rank ) {
+      if( counts[ rank ] ) {
+        std::copy( counts, counts + SHORT_DECK_RANKS, smaller );
+        --smaller[ rank ];
+        unsigned short value = smallerTable[ quinaryHash( smaller, numberOfCards - 1 ) ];
+        if( value < bestValue ) {
+          bestValue = value;
+        }
+      }
+    }
+    return bestValue;
+  };
+
+  forEachRankMultiset( rankCounts, 0, 6, [&]( const unsigned char counts[] ) {
+      ranks6[ quinaryHash( counts, 6 ) ] = reduce( counts, 6, ranks5 );
+    } );
+
+  forEachRankMultiset( rankCounts, 0, 7, [&]( const unsigned char counts[] ) {
+      ranks7[ quinaryHash( counts, 7 ) ] = reduce( counts, 7, ranks6 );
+    } );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+ShortDeckEvaluator::ShortDeckEvaluator()
+{
+  std::call_once( tablesInitialized_, generateTables );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+const unsigned short* ShortDeckEvaluator::rankTable( unsigned int numberOfCards )
+{
+  switch( numberOfCards ) {
+  case 5:
+    return ranks5;
+  case 6:
+    return ranks6;
+  default:
+    return ranks7;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+inline unsigned int ShortDeckEvaluator::evaluate( const HandCounts& counts, unsigned int numberOfCards )
+{
+  // with at most seven cards a flush rules out quads, and only a straight flush beats it
+  unsigned int flushSuits = ( counts.suitCounter + 0x3333 ) & 0x8888;
+  if( flushSuits ) {
+    return flushes[ counts.suitMasks[ __builtin_ctz( flushSuits ) >> 2 ] ];
+  }
+
+  return rankTable( numberOfCards )[ quinaryHash( counts.rankCounts, numberOfCards ) ];
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int ShortDeckEvaluator::evaluate( const unsigned int rawCards[], unsigned int numberOfCards ) const
+{
+  HandCounts counts = { { 0 }, { 0, 0, 0, 0 }, 0 };
+  for( unsigned int i = 0; i < numberOfCards; ++i ) {
+    unsigned int raw = rawCards[ i ];
+    unsigned int suit = __builtin_ctz( raw >> 12 );
+    ++counts.rankCounts[ ( ( raw >> 8 ) & 0x0f ) - SIX ];
+    counts.suitMasks[ suit ] |= raw >> ( 16 + SIX );
+    counts.suitCounter += 1 << ( suit << 2 );
+  }
+
+  return evaluate( counts, numberOfCards );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int ShortDeckEvaluator::evaluate( CardSet hand ) const
+{
+  unsigned int numberOfCards = hand.size();
+  if( numberOfCards < 5 || numberOfCards > 7 || ( hand.mask() & ( ( 1ULL << SHORT_DECK_FIRST_CARD ) - 1 ) ) ) {
+    throw std::logic_error( "Five to seven cards from six to ace are needed for short deck evaluation." );
+  }
+
+  HandCounts counts = { { 0 }, { 0, 0, 0, 0 }, 0 };
+  for( std::uint64_t m = hand.mask(); m; m &= m - 1 ) {
+    counts.add( __builtin_ctzll( m ) );
+  }
+
+  return evaluate( counts, numberOfCards );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int ShortDeckEvaluator::evaluateHoldemHand( CardSet holeCards, CardSet commonCards ) const
+{
+  if( holeCards.size() != 2 || commonCards.size() < 3 || commonCards.size() > 5 || holeCards.intersects( commonCards ) ) {
+    throw std::logic_error( "Hold'em needs 2 hole cards and 3 to 5 other common cards." );
+  }
+
+  return evaluate( holeCards | commonCards );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+ShowdownResult ShortDeckEvaluator::showdown( CardSet commonCards, const CardSet holeCards[],
+                                             unsigned int numberOfSeats ) const
+{
+  if( numberOfSeats == 0 || numberOfSeats > MAX_SEATS ) {
+    throw std::logic_error( "A showdown needs 1 to 10 seats." );
+  }
+  if( commonCards.size() != 5 || ( commonCards.mask() & ( ( 1ULL << SHORT_DECK_FIRST_CARD ) - 1 ) ) ) {
+    throw std::logic_error( "A short deck showdown needs 5 common cards from six to ace." );
+  }
+  CardSet usedCards = commonCards;
+  for( unsigned int seat = 0; seat < numberOfSeats; ++seat ) {
+    if( holeCards[ seat ].size() != 2 || ( holeCards[ seat ].mask() & ( ( 1ULL << SHORT_DECK_FIRST_CARD ) - 1 ) ) ) {
+      throw std::logic_error( "Short deck Hold'em needs 2 hole cards from six to ace." );
+    }
+    if( usedCards.mask() & holeCards[ seat ].mask() ) {
+      throw std::logic_error( "The same card is given twice." );
+    }
+    usedCards |= holeCards[ seat ];
+  }
+
+  HandCounts board = { { 0 }, { 0, 0, 0, 0 }, 0 };
+  for( std::uint64_t m = commonCards.mask(); m; m &= m - 1 ) {
+    board.add( __builtin_ctzll( m ) );
+  }
+
+  ShowdownResult result;
+  for( unsigned int seat = 0; seat < numberOfSeats; ++seat ) {
+    HandCounts counts = board;
+    std::uint64_t m = holeCards[ seat ].mask();
+    counts.add( __builtin_ctzll( m ) );
+    counts.add( 63 - __builtin_clzll( m ) );
+    result.values[ seat ] = evaluate( counts, 7 );
+  }
+
+  result.settle( numberOfSeats );
+
+  return result;
+}
@@ -0,0 +1,78 @@
+#ifndef POKER_SHORT_DECK_EVALUATOR_H
+#define POKER_SHORT_DECK_EVALUATOR_H
+
+#include <mutex>
+#include "CardDeck.h"
+#include "FiveOfSevenCardEvaluator.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#define SHORT_DECK_RANKS 9
+#define SHORT_DECK_FLUSH_TABLE_SIZE 512
+#define SHORT_DECK_RANK_TABLE_SIZE_5 1278
+#define SHORT_DECK_RANK_TABLE_SIZE_6 2922
+#define SHORT_DECK_RANK_TABLE_SIZE_7 6030
+#define NUMBER_OF_SHORT_DECK_VALUES 1404
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Evaluator for short deck (6+) Hold'em, played with the 36 cards from six to
+// ace. A flush beats a full house and A-6-7-8-9 is the lowest straight, all
+// other hands rank as in the full deck. Values run from 1 for a royal flush to
+// 1404 for J-9-8-7-6, lower is better, and are not comparable with the
+// FiveCardEvaluator scale.
+//
+// Works like FiveOfSevenCardEvaluator on Card::raw() values: a suit with five or
+// more cards is looked up by its 9 bit rank mask, everything else by a quinary
+// hash of the rank multiset into one table per number of cards.
+class ShortDeckEvaluator {
+private:
+   static unsigned short flushes[ SHORT_DECK_FLUSH_TABLE_SIZE ];
+   static unsigned short ranks5[ SHORT_DECK_RANK_TABLE_SIZE_5 ];
+   static unsigned short ranks6[ SHORT_DECK_RANK_TABLE_SIZE_6 ];
+   static unsigned short ranks7[ SHORT_DECK_RANK_TABLE_SIZE_7 ];
+   static unsigned int quinaryOffsets[ SHORT_DECK_RANKS ][ 8 ][ 5 ];
+   static unsigned char handRanks[ NUMBER_OF_SHORT_DECK_VALUES + 1 ];
+   static std::once_flag tablesInitialized_;
+
+   // rank counts and suits of the cards seen so far, by Card::index()
+   struct HandCounts {
+      unsigned char rankCounts[ SHORT_DECK_RANKS ];
+      unsigned int suitMasks[ 4 ];
+      unsigned int suitCounter;   // one nibble per suit
+
+      inline void add( unsigned int cardIndex )
+      {
+         unsigned int rank = ( cardIndex >> 2 ) - SIX;
+         unsigned int suit = cardIndex & 0x03;
+         ++rankCounts[ rank ];
+         suitMasks[ suit ] |= 1 << rank;
+         suitCounter += 1 << ( suit << 2 );
+      }
+   };
+
+   static void generateTables();
+   static unsigned int evaluate( const HandCounts& counts, unsigned int numberOfCards );
+   static unsigned int quinaryHash( const unsigned char rankCounts[], unsigned int numberOfCards );
+   static const unsigned short* rankTable( unsigned int numberOfCards );
+
+public:
+   ShortDeckEvaluator();
+
+   // 5 to 7 Card::raw() values, all six or higher
+   unsigned int evaluate( const unsigned int rawCards[], unsigned int numberOfCards ) const;
+   unsigned int evaluate( CardSet hand ) const;
+
+   // 2 hole cards and 3, 4 or 5 common cards
+   unsigned int evaluateHoldemHand( CardSet holeCards, CardSet commonCards ) const;
+
+   // Showdown of 1 to MAX_SEATS hole card pairs on five common cards. The board
+   // is counted once, each seat then only adds its two cards. Every seat needs 2
+   // cards from six to ace, none of them on the board or in another seat.
+   ShowdownResult showdown( CardSet commonCards, const CardSet holeCards[], unsigned int numberOfSeats ) const;
+
+   // valid once an evaluator has been constructed
+   static inline HandRank handRank( unsigned int value ) { return (HandRank) handRanks[ value ]; }
+};
+
+#endif
@@ -0,0 +1,158 @@
+#include <stdexcept>
+
+#include "StudEvaluator.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int StudEvaluator::evaluateRazz( CardSet cards )
+{
+  std::uint64_t mask = cards.mask();
+  unsigned int rankBits = 0;
+  for( unsigned int rank = 0; rank < 13; ++rank ) {
+    rankBits |= ( ( ( mask >> ( rank << 2 ) ) & 0x0f ) != 0 ) << rank;
+  }
+
+  // the five lowest different ranks make the hand whenever there are five
+  unsigned int lowRanks = LowballEvaluator::aceLowRanks( rankBits );
+  if( __builtin_popcount( lowRanks ) >= 5 ) {
+    while( __builtin_popcount( lowRanks ) > 5 ) {
+      lowRanks &= ~( 1u << ( 31 - __builtin_clz( lowRanks ) ) );
+    }
+    return lowballTables.aceToFive[ lowRanks ];
+  }
+
+  unsigned int raw[ STUD_CARDS ];
+  unsigned int numberOfCards = cards.indices( raw );
+  for( unsigned int i = 0; i < numberOfCards; ++i ) {
+    raw[ i ] = Card::rawCard( raw[ i ] );
+  }
+  return LowballEvaluator::evaluateAceToFive( raw, numberOfCards );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int StudEvaluator::evaluate( StudGame game, CardSet cards ) const
+{
+  return game == RAZZ ? evaluateRazz( cards ) : highEvaluator_.evaluate( cards );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+void StudEvaluator::dealStreet( CardDeck& deck, StudHand seats[], unsigned int numberOfSeats )
+{
+  // too few cards left for a seventh street card each: one community card is
+  // turned up and is the last card of every seat
+  unsigned int seventhStreetSeats = 0;
+  for( unsigned int seat = 0; seat < numberOfSeats; ++seat ) {
+    seventhStreetSeats += seats[ seat ].size() == STUD_CARDS - 1;
+  }
+  bool communityCard = seventhStreetSeats > deck.remainingCards().size();
+  unsigned int communityCardIndex = communityCard ? deck.dealCardIndex() : 0;
+
+  for( unsigned int seat = 0; seat < numberOfSeats; ++seat ) {
+    unsigned int numberOfCards = seats[ seat ].size();
+    if( communityCard && numberOfCards == STUD_CARDS - 1 ) {
+      seats[ seat ].upCards.add( communityCardIndex );
+      continue;
+    }
+    unsigned int lastCard = numberOfCards < 3 ? 3 : std::min( numberOfCards + 1, (unsigned int) STUD_CARDS );
+    for( ; numberOfCards < lastCard; ++numberOfCards ) {
+      CardSet& cards = StudHand::isUpCard( numberOfCards ) ? seats[ seat ].upCards : seats[ seat ].downCards;
+      cards.add( deck.dealCardIndex() );
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+ShowdownResult StudEvaluator::showdown( StudGame game, const StudHand seats[], unsigned int numberOfSeats ) const
+{
+  if( numberOfSeats == 0 || numberOfSeats > MAX_SEATS ) {
+    throw std::logic_error( "A showdown needs 1 to 10 seats." );
+  }
+
+  ShowdownResult result;
+  for( unsigned int seat = 0; seat < numberOfSeats; ++seat ) {
+    unsigned int numberOfCards = seats[ seat ].size();
+    if( numberOfCards < 5 || numberOfCards > STUD_CARDS ) {
+      throw std::logic_error( "Five to seven cards are needed for evaluation." );
+    }
+    result.values[ seat ] = evaluate( game, seats[ seat ].cards() );
+  }
+
+  result.settle( numberOfSeats );
+
+  return result;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+void StudEvaluator::equity( StudGame game, const StudHand seats[], unsigned int numberOfSeats, CardSet deadCards,
+                            unsigned int numberOfTrials, CardDeck& deck, double equities[] ) const
+{
+  if( numberOfSeats == 0 || numberOfSeats > MAX_STUD_SEATS || numberOfTrials == 0 ) {
+    throw std::logic_error( "Stud equity needs 1 to 8 seats and one trial or more." );
+  }
+
+  // the trials deal from a deck of their own, locking every known card in it
+  // also rejects cards given twice
+  CardDeck trialDeck = deck.split();
+  CardSet knownCards = deadCards;
+  unsigned int missingCards[ MAX_SEATS ];
+  unsigned int numberOfMissingCards = 0;
+  unsigned int seatsMissingCards = 0;
+  for( unsigned int seat = 0; seat < numberOfSeats; ++seat ) {
+    if( seats[ seat ].size() > STUD_CARDS || seats[ seat ].downCards.intersects( seats[ seat ].upCards ) ) {
+      throw std::logic_error( "A stud seat holds at most seven different cards." );
+    }
+    knownCards |= seats[ seat ].cards();
+    missingCards[ seat ] = STUD_CARDS - seats[ seat ].size();
+    numberOfMissingCards += missingCards[ seat ];
+    seatsMissingCards += missingCards[ seat ] > 0;
+    equities[ seat ] = 0.0;
+  }
+
+  unsigned int cardIndices[ CARDS_IN_DECK ];
+  unsigned int numberOfKnownCards = knownCards.indices( cardIndices );
+  for( unsigned int i = 0; i < numberOfKnownCards; ++i ) {
+    trialDeck.lockCard( cardIndices[ i ] );
+  }
+
+  // as in dealStreet, a seventh street short of cards is one community card for
+  // every seat, which then all still miss their last card
+  unsigned int cardsInDeck = trialDeck.deckType() == SHORT_DECK ? CARDS_IN_SHORT_DECK : CARDS_IN_DECK;
+  bool communityCard = numberOfKnownCards + numberOfMissingCards > cardsInDeck;
+  if( communityCard ) {
+    if( seatsMissingCards < numberOfSeats
+        || numberOfKnownCards + numberOfMissingCards - numberOfSeats + 1 > cardsInDeck ) {
+      throw std::logic_error( "Not enough cards left to deal every stud seat seven cards." );
+    }
+    for( unsigned int seat = 0; seat < numberOfSeats; ++seat ) {
+      --missingCards[ seat ];
+    }
+  }
+
+  StudHand hands[ MAX_SEATS ];
+  for( unsigned int trial = 0; trial < numberOfTrials; ++trial ) {
+    for( unsigned int seat = 0; seat < numberOfSeats; ++seat ) {
+      hands[ seat ].upCards = seats[ seat ].upCards;
+      hands[ seat ].downCards = seats[ seat ].downCards | trialDeck.dealCards( missingCards[ seat ] );
+    }
+    if( communityCard ) {
+      unsigned int communityCardIndex = trialDeck.dealCardIndex();
+      for( unsigned int seat = 0; seat < numberOfSeats; ++seat ) {
+        hands[ seat ].upCards.add( communityCardIndex );
+      }
+    }
+    trialDeck.clean();
+
+    ShowdownResult result = showdown( game, hands, numberOfSeats );
+    for( unsigned int seat = 0; seat < numberOfSeats; ++seat ) {
+      equities[ seat ] += result.shares[ seat ];
+    }
+  }
+
+  for( unsigned int seat = 0; seat < numberOfSeats; ++seat ) {
+    equities[ seat ] /= numberOfTrials;
+  }
+}
@@ -0,0 +1,68 @@
+#ifndef POKER_STUD_EVALUATOR_H
+#define POKER_STUD_EVALUATOR_H
+
+#include "CardDeck.h"
+#include "FiveOfSevenCardEvaluator.h"
+#include "LowballEvaluator.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#define STUD_CARDS 7
+#define MAX_STUD_SEATS 8   // 8 seats with six cards each leave a card for seventh street
+
+enum StudGame {
+   SEVEN_CARD_STUD = 0,   // high hand, FiveOfSevenCardEvaluator values
+   RAZZ                   // ace to five low, LowballEvaluator values
+};
+
+// The cards of one stud seat. Third street deals two down cards and one up card,
+// fourth to sixth street one up card each and seventh street a last down card.
+struct StudHand {
+   CardSet downCards;
+   CardSet upCards;
+
+   inline CardSet cards() const { return downCards | upCards; }
+   inline unsigned int size() const { return downCards.size() + upCards.size(); }
+
+   // whether the card dealt as card number cardNumber, counted from 0, is shown
+   static inline bool isUpCard( unsigned int cardNumber ) { return cardNumber >= 2 && cardNumber < 6; }
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Seven card stud and Razz on whole hands of 5 to 7 cards, there is no board to
+// split off. The high hand goes through the single pass FiveOfSevenCardEvaluator,
+// Razz takes the five lowest ranks straight from the rank mask and only falls
+// back to LowballEvaluator when fewer than five ranks are different. Both scales
+// are lower is better.
+//
+// Dealing goes through a CardDeck: cards locked in the deck are known, either in
+// a seat or dead (folded or exposed), and are never dealt again. Eight seats need
+// 56 cards, so when seventh street finds fewer cards left than seats the stud
+// rule applies: a single community card is turned up and shared by all of them.
+class StudEvaluator {
+private:
+   FiveOfSevenCardEvaluator highEvaluator_;
+
+public:
+   static unsigned int evaluateRazz( CardSet cards );
+   unsigned int evaluate( StudGame game, CardSet cards ) const;
+
+   // Deals the next street to every one of up to MAX_STUD_SEATS seats that has
+   // fewer than STUD_CARDS cards, seventh street as one shared up card when the
+   // deck is short.
+   static void dealStreet( CardDeck& deck, StudHand seats[], unsigned int numberOfSeats );
+
+   // Showdown of 1 to MAX_SEATS complete hands.
+   ShowdownResult showdown( StudGame game, const StudHand seats[], unsigned int numberOfSeats ) const;
+
+   // Monte Carlo equity of 1 to MAX_STUD_SEATS seats on any street. Every trial deals
+   // each seat up to seven cards, with a community card when the deck is short,
+   // and plays a showdown; equities[ seat ] gets the average pot share. The
+   // seats' cards and deadCards are locked in deck.split(), so deck itself only
+   // gives up two random numbers.
+   void equity( StudGame game, const StudHand seats[], unsigned int numberOfSeats, CardSet deadCards,
+                unsigned int numberOfTrials, CardDeck& deck, double equities[] ) const;
+};
+
+#endif
@@ -0,0 +1,61 @@
+#include <stdexcept>
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <immintrin.h>
+#endif
+
+#include "SuitMaskEvaluator.h"
+#include "CpuDispatch.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int SuitMaskEvaluator::evaluateScalar( std::uint64_t cards )
+{
+  CardSet cardSet( cards );
+  return evaluate( suitMask( cardSet, CLUB ), suitMask( cardSet, DIAMOND ), suitMask( cardSet, HEART ),
+                   suitMask( cardSet, SPADE ) );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+__attribute__(( target( "bmi,bmi2" ) ))
+unsigned int SuitMaskEvaluator::evaluateBmi2( std::uint64_t cards )
+{
+  return evaluate( _pext_u64( cards, 0x1111111111111ULL << CLUB ), _pext_u64( cards, 0x1111111111111ULL << DIAMOND ),
+                   _pext_u64( cards, 0x1111111111111ULL << HEART ), _pext_u64( cards, 0x1111111111111ULL << SPADE ) );
+}
+#endif
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int SuitMaskEvaluator::evaluate( CardSet cards )
+{
+  static const CardSetKernel kernel = dispatchKernel< CardSetKernel >( &evaluateScalar, nullptr, X86_KERNEL( &evaluateBmi2 ), nullptr );
+  return kernel( cards.mask() );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int SuitMaskEvaluator::evaluate( const Hand& hand ) const
+{
+  return evaluateHoldemHand( CardSet( hand ), CardSet() );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int SuitMaskEvaluator::evaluateHoldemHand( CardSet holeCards, CardSet commonCards ) const
+{
+  CardSet cards = holeCards | commonCards;
+  if( cards.size() < 5 || cards.size() > 7 || holeCards.intersects( commonCards ) ) {
+    throw std::logic_error( "Five to seven different cards are needed for evaluation." );
+  }
+
+  return evaluate( cards );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int SuitMaskEvaluator::evaluateHoldemHand( const Hand& holeCards, const Hand& commonCards ) const
+{
+  return evaluateHoldemHand( CardSet( holeCards ), CardSet( commonCards ) );
+}
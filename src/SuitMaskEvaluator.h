@@ -0,0 +1,153 @@
+#ifndef POKER_SUIT_MASK_EVALUATOR_H
+#define POKER_SUIT_MASK_EVALUATOR_H
+
+#include <cstdint>
+#include "CardDeck.h"
+#include "FiveCardEvaluatorTables.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Evaluates 5 to 7 cards given as four 13 bit rank masks, one per suit, without
+// prime products or hashing. Pairs, trips and quads fall out of ANDs and ORs of
+// the suit masks, straights out of shifted ANDs, and the hand value is computed
+// from the ranks involved: within a category Cactus Kev's values count down in
+// lexicographic order, so the kickers only need their combinatorial rank after
+// the ranks already used are squeezed out. Only flushes and high cards are looked
+// up in the FiveCardEvaluator tables, by their five card rank mask.
+//
+// The values are on the same 1..7462 scale as FiveCardEvaluator. The suit masks
+// of a CardSet are gathered by PEXT where the CPU has BMI2, chosen at run time.
+class SuitMaskEvaluator {
+private:
+   static constexpr unsigned int binomials[ 13 ][ 4 ] = {
+      { 0, 0, 0, 0 }, { 1, 1, 0, 0 }, { 1, 2, 1, 0 }, { 1, 3, 3, 1 }, { 1, 4, 6, 4 },
+      { 1, 5, 10, 10 }, { 1, 6, 15, 20 }, { 1, 7, 21, 35 }, { 1, 8, 28, 56 }, { 1, 9, 36, 84 },
+      { 1, 10, 45, 120 }, { 1, 11, 55, 165 }, { 1, 12, 66, 220 }
+   };
+
+   static inline unsigned int highestRank( unsigned int rankBits ) { return 31 - __builtin_clz( rankBits ); }
+
+   // keeps the n highest ranks
+   static inline unsigned int highestRanks( unsigned int rankBits, int n )
+   {
+      while( __builtin_popcount( rankBits ) > n ) {
+         rankBits &= rankBits - 1;
+      }
+      return rankBits;
+   }
+
+   // position of rank once the used ranks are squeezed out
+   static inline unsigned int squeeze( unsigned int rank, unsigned int usedRanks )
+   {
+      return rank - __builtin_popcount( usedRanks & ( ( 1 << rank ) - 1 ) );
+   }
+
+   // colex rank of the kicker set among all sets of the same size, after squeezing
+   static inline unsigned int kickerRank( unsigned int kickers, unsigned int usedRanks )
+   {
+      unsigned int rank = 0;
+      for( unsigned int i = 1; kickers; ++i, kickers &= kickers - 1 ) {
+         rank += binomials[ squeeze( __builtin_ctz( kickers ), usedRanks ) ][ i ];
+      }
+      return rank;
+   }
+
+   // low card of the best straight, 1 for the wheel up to 10 for broadway, 0 if none
+   static inline unsigned int straight( unsigned int rankBits )
+   {
+      unsigned int r = ( rankBits << 1 ) | ( ( rankBits >> 12 ) & 1 );
+      unsigned int straights = r & ( r >> 1 ) & ( r >> 2 ) & ( r >> 3 ) & ( r >> 4 );
+      return straights ? 32 - __builtin_clz( straights ) : 0;
+   }
+
+   static inline unsigned int flushValue( unsigned int suitMask )
+   {
+      unsigned int low = straight( suitMask );
+      return low ? 11 - low : fiveCardEvaluatorTables.flushes[ highestRanks( suitMask, 5 ) ];
+   }
+
+   typedef unsigned int ( *CardSetKernel )( std::uint64_t cards );
+
+   static unsigned int evaluateScalar( std::uint64_t cards );
+   static unsigned int evaluateBmi2( std::uint64_t cards );
+
+public:
+   // rank bits of one suit out of a CardSet, where card rank * 4 + suit is bit rank * 4 + suit
+   static inline unsigned int suitMask( CardSet cards, unsigned int suit )
+   {
+      std::uint64_t x = ( cards.mask() >> suit ) & 0x1111111111111ULL;
+      x = ( x | ( x >> 3 ) ) & 0x0303030303030303ULL;
+      x = ( x | ( x >> 6 ) ) & 0x000f000f000f000fULL;
+      x = ( x | ( x >> 12 ) ) & 0x000000ff000000ffULL;
+      return ( x | ( x >> 24 ) ) & 0xffff;
+   }
+
+   static inline unsigned int evaluate( unsigned int clubs, unsigned int diamonds, unsigned int hearts, unsigned int spades )
+   {
+      // with at most seven cards only one suit can flush, and nothing a flush
+      // allows besides a straight flush beats it
+      if( __builtin_popcount( clubs ) >= 5 ) {
+         return flushValue( clubs );
+      }
+      if( __builtin_popcount( diamonds ) >= 5 ) {
+         return flushValue( diamonds );
+      }
+      if( __builtin_popcount( hearts ) >= 5 ) {
+         return flushValue( hearts );
+      }
+      if( __builtin_popcount( spades ) >= 5 ) {
+         return flushValue( spades );
+      }
+
+      unsigned int ranks = clubs | diamonds | hearts | spades;
+      unsigned int pairsOrMore = ( clubs & diamonds ) | ( hearts & spades ) | ( ( clubs | diamonds ) & ( hearts | spades ) );
+      unsigned int tripsOrMore = ( clubs & diamonds & ( hearts | spades ) ) | ( hearts & spades & ( clubs | diamonds ) );
+      unsigned int quads = clubs & diamonds & hearts & spades;
+
+      if( quads ) {
+         unsigned int quad = highestRank( quads );
+         unsigned int kicker = highestRank( ranks & ~( 1 << quad ) );
+         return 11 + ( 12 - quad ) * 12 + 11 - squeeze( kicker, 1 << quad );
+      }
+
+      unsigned int trips = 0;
+      if( tripsOrMore ) {
+         trips = highestRank( tripsOrMore );
+         unsigned int pairs = pairsOrMore & ~( 1 << trips );
+         if( pairs ) {
+            return 167 + ( 12 - trips ) * 12 + 11 - squeeze( highestRank( pairs ), 1 << trips );
+         }
+      }
+
+      unsigned int low = straight( ranks );
+      if( low ) {
+         return 1610 - low;
+      }
+
+      if( tripsOrMore ) {
+         unsigned int used = 1 << trips;
+         return 1610 + ( 12 - trips ) * 66 + 65 - kickerRank( highestRanks( ranks & ~used, 2 ), used );
+      }
+
+      if( pairsOrMore & ( pairsOrMore - 1 ) ) {
+         unsigned int used = highestRanks( pairsOrMore, 2 );
+         unsigned int kicker = highestRank( ranks & ~used );
+         return 2468 + ( 77 - kickerRank( used, 0 ) ) * 11 + 10 - squeeze( kicker, used );
+      }
+
+      if( pairsOrMore ) {
+         return 3326 + ( 12 - highestRank( pairsOrMore ) ) * 220 + 219
+            - kickerRank( highestRanks( ranks & ~pairsOrMore, 3 ), pairsOrMore );
+      }
+
+      return fiveCardEvaluatorTables.unique5[ highestRanks( ranks, 5 ) ];
+   }
+
+   static unsigned int evaluate( CardSet cards );
+
+   unsigned int evaluate( const Hand& hand ) const;
+   unsigned int evaluateHoldemHand( CardSet holeCards, CardSet commonCards ) const;
+   unsigned int evaluateHoldemHand( const Hand& holeCards, const Hand& commonCards ) const;
+};
+
+#endif